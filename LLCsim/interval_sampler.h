@@ -0,0 +1,120 @@
+#ifndef INTERVAL_SAMPLER_H
+#define INTERVAL_SAMPLER_H
+
+/*
+** Fixed-size ring of per-interval replacement samples. The ring is allocated
+** once up front; when it is full the oldest sample is overwritten, so a run
+** of any length keeps the most recent Capacity() intervals.
+**
+** Counts in a sample are for that interval only, PSEL and the EAF fill level
+** are the values at the end of it.
+*/
+
+#include <cassert>
+#include <iostream>
+#include "utils.h"
+
+typedef struct
+{
+    UINT64  timer;          // mytimer when the sample was taken
+    UINT64  hits;
+    UINT64  misses;
+    UINT32  psel;
+    UINT32  eafFill;        // addresses currently held in the EAF
+    // insertion class mix
+    UINT64  insSRRIP;       // DRRIP insertions with SRRIP
+    UINT64  insBRRIP;       // DRRIP insertions with BRRIP
+    UINT64  insSHiPGood;
+    UINT64  insSHiPBad;
+    UINT64  insEAFGood;
+    UINT64  insEAFBad;
+} INTERVAL_SAMPLE;
+
+class INTERVAL_SAMPLER
+{
+  private:
+    INTERVAL_SAMPLE *ring;
+    UINT32 capacity;
+    UINT32 head;            // next slot to write
+    UINT32 count;
+
+    INTERVAL_SAMPLER( const INTERVAL_SAMPLER & );
+    INTERVAL_SAMPLER & operator=( const INTERVAL_SAMPLER & );
+
+    const INTERVAL_SAMPLE & At( UINT32 ii ) const
+    {
+        // ii-th oldest sample
+        return ring[ (head + capacity - count + ii) % capacity ];
+    }
+
+  public:
+    INTERVAL_SAMPLER() : ring(NULL), capacity(0), head(0), count(0) {}
+    ~INTERVAL_SAMPLER() { delete [] ring; }
+
+    void Init( UINT32 _capacity )
+    {
+        assert(_capacity > 0);
+        delete [] ring;
+        ring     = new INTERVAL_SAMPLE[ _capacity ];
+        capacity = _capacity;
+        head     = 0;
+        count    = 0;
+    }
+
+    UINT32 Capacity() const { return capacity; }
+    UINT32 Count() const    { return count; }
+
+    // Returns the slot for a new sample, overwriting the oldest when full
+    INTERVAL_SAMPLE & Next()
+    {
+        INTERVAL_SAMPLE &slot = ring[ head ];
+        head = (head + 1) % capacity;
+        if( count < capacity ) count++;
+        return slot;
+    }
+
+    ostream & PrintCSV( ostream &out ) const
+    {
+        out<<"timer,hits,misses,hit_rate,psel,eaf_fill,"
+           <<"ins_srrip,ins_brrip,ins_ship_good,ins_ship_bad,ins_eaf_good,ins_eaf_bad"<<endl;
+        for( UINT32 ii = 0; ii < count; ii++ )
+        {
+            const INTERVAL_SAMPLE &s = At(ii);
+            UINT64 acc = s.hits + s.misses;
+            out<<s.timer<<","<<s.hits<<","<<s.misses<<","
+               <<(acc ? (double) s.hits / acc : 0.0)<<","
+               <<s.psel<<","<<s.eafFill<<","
+               <<s.insSRRIP<<","<<s.insBRRIP<<","
+               <<s.insSHiPGood<<","<<s.insSHiPBad<<","
+               <<s.insEAFGood<<","<<s.insEAFBad<<endl;
+        }
+        return out;
+    }
+
+    ostream & PrintJSON( ostream &out ) const
+    {
+        out<<"["<<endl;
+        for( UINT32 ii = 0; ii < count; ii++ )
+        {
+            const INTERVAL_SAMPLE &s = At(ii);
+            UINT64 acc = s.hits + s.misses;
+            out<<"  {\"timer\": "<<s.timer
+               <<", \"hits\": "<<s.hits
+               <<", \"misses\": "<<s.misses
+               <<", \"hit_rate\": "<<(acc ? (double) s.hits / acc : 0.0)
+               <<", \"psel\": "<<s.psel
+               <<", \"eaf_fill\": "<<s.eafFill
+               <<", \"ins_srrip\": "<<s.insSRRIP
+               <<", \"ins_brrip\": "<<s.insBRRIP
+               <<", \"ins_ship_good\": "<<s.insSHiPGood
+               <<", \"ins_ship_bad\": "<<s.insSHiPBad
+               <<", \"ins_eaf_good\": "<<s.insEAFGood
+               <<", \"ins_eaf_bad\": "<<s.insEAFBad
+               <<"}"<<(ii + 1 < count ? "," : "")<<endl;
+        }
+        out<<"]"<<endl;
+        return out;
+    }
+};
+
+#endif
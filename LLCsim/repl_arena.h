@@ -0,0 +1,108 @@
+#ifndef REPL_ARENA_H
+#define REPL_ARENA_H
+
+/*
+** Single-block bump allocator for the replacement state. The owner first
+** Plan()s every allocation, Reserve()s once, then carves the block with
+** Alloc() in the same order. Memory comes back zeroed and is only returned
+** as a whole by Release() or the destructor.
+**
+** Blocks of HugePageBytes or more are mmap'ed and advised for transparent
+** huge pages. Smaller ones come from calloc. Either way, untouched pages of
+** a large table cost no RSS until the policy actually uses them.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include "utils.h"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+class REPL_ARENA
+{
+  private:
+    static const size_t Align = 64;     // cache line
+    static const size_t HugePageBytes = 2 * 1024 * 1024;
+
+    UINT8  *block;      // what was allocated
+    UINT8  *base;       // block rounded up to Align
+    size_t planned;
+    size_t blockBytes;
+    size_t used;
+    bool   mapped;
+
+    REPL_ARENA( const REPL_ARENA & );
+    REPL_ARENA & operator=( const REPL_ARENA & );
+
+    static size_t AlignUp( size_t bytes ) { return (bytes + Align - 1) & ~(Align - 1); }
+
+  public:
+    REPL_ARENA() : block(NULL), base(NULL), planned(0), blockBytes(0), used(0), mapped(false) {}
+    ~REPL_ARENA() { Release(); }
+
+    void Plan( size_t bytes ) { planned += AlignUp(bytes); }
+
+    void Reserve()
+    {
+        assert(!block);
+        if( planned == 0 ) return;
+
+        blockBytes = planned + Align;
+#ifdef __linux__
+        if( blockBytes >= HugePageBytes )
+        {
+            void *p = mmap(NULL, blockBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if( p != MAP_FAILED )
+            {
+                madvise(p, blockBytes, MADV_HUGEPAGE);
+                block  = (UINT8 *) p;
+                mapped = true;
+            }
+        }
+#endif
+        if( !block ) block = (UINT8 *) calloc(blockBytes, 1);
+        assert(block);
+
+        base = (UINT8 *) (((size_t) block + Align - 1) & ~(Align - 1));
+        used = 0;
+    }
+
+    void * Alloc( size_t bytes )
+    {
+        if( bytes == 0 ) return NULL;
+        void *p = base + used;
+        used += AlignUp(bytes);
+        assert(used <= planned);
+        return p;
+    }
+
+    void Release()
+    {
+#ifdef __linux__
+        if( mapped ) munmap(block, blockBytes);
+        else
+#endif
+        free(block);
+
+        block = base = NULL;
+        planned = blockBytes = used = 0;
+        mapped = false;
+    }
+
+    size_t Bytes() const { return planned; }
+
+    void Swap( REPL_ARENA &other )
+    {
+        std::swap(block, other.block);
+        std::swap(base, other.base);
+        std::swap(planned, other.planned);
+        std::swap(blockBytes, other.blockBytes);
+        std::swap(used, other.used);
+        std::swap(mapped, other.mapped);
+    }
+};
+
+#endif
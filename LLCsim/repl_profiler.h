@@ -0,0 +1,173 @@
+#ifndef REPL_PROFILER_H
+#define REPL_PROFILER_H
+
+/*
+** Hot-spot profiler for replacement behavior. Only built when REPL_PROFILE
+** is defined; without it CACHE_REPLACEMENT_STATE carries none of this state
+** and the hooks are compiled out.
+**
+** Per-set miss and eviction counters feed the heatmap. PCs are tracked with
+** two bounded Space-Saving sketches (Metwally et al.): one for misses, one
+** for dead-on-arrival lines, i.e. lines evicted without a hit, charged to
+** the PC that filled them. A sketch of K slots reports every PC whose true
+** count exceeds total/K, with at most `error` overcount.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "utils.h"
+
+// Slots per PC sketch, set by CACHE_REPLACEMENT_STATE when it creates the
+// profiler. Override with -DREPL_PROFILER_SKETCH_SLOTS=N.
+#ifndef REPL_PROFILER_SKETCH_SLOTS
+#define REPL_PROFILER_SKETCH_SLOTS 64
+#endif
+
+typedef struct
+{
+    Addr_t  PC;
+    UINT64  count;
+    UINT64  error;  // upper bound of the overcount
+} SPACE_SAVING_ENTRY;
+
+class SPACE_SAVING_SKETCH
+{
+  private:
+    SPACE_SAVING_ENTRY *slots;
+    UINT32 numSlots;
+    UINT32 used;
+    UINT64 total;
+
+    SPACE_SAVING_SKETCH( const SPACE_SAVING_SKETCH & );
+    SPACE_SAVING_SKETCH & operator=( const SPACE_SAVING_SKETCH & );
+
+    static bool ByCount( const SPACE_SAVING_ENTRY &a, const SPACE_SAVING_ENTRY &b )
+    {
+        return a.count > b.count;
+    }
+
+  public:
+    SPACE_SAVING_SKETCH() : slots(NULL), numSlots(0), used(0), total(0) {}
+    ~SPACE_SAVING_SKETCH() { delete [] slots; }
+
+    void Init( UINT32 _slots )
+    {
+        delete [] slots;
+        slots    = new SPACE_SAVING_ENTRY[ _slots ];
+        numSlots = _slots;
+        used     = 0;
+        total    = 0;
+    }
+
+    void Add( Addr_t PC )
+    {
+        total++;
+
+        UINT32 minSlot = 0;
+        for( UINT32 ii = 0; ii < used; ii++ )
+        {
+            if( slots[ii].PC == PC )
+            {
+                slots[ii].count++;
+                return;
+            }
+            if( slots[ii].count < slots[minSlot].count ) minSlot = ii;
+        }
+
+        if( used < numSlots )
+        {
+            slots[used].PC    = PC;
+            slots[used].count = 1;
+            slots[used].error = 0;
+            used++;
+            return;
+        }
+
+        // evict the smallest counter, the newcomer inherits its count
+        slots[minSlot].PC    = PC;
+        slots[minSlot].error = slots[minSlot].count;
+        slots[minSlot].count++;
+    }
+
+    ostream & PrintTop( ostream &out, const char *what, UINT32 topN ) const
+    {
+        SPACE_SAVING_ENTRY *sorted = new SPACE_SAVING_ENTRY[ used ? used : 1 ];
+        std::copy( slots, slots + used, sorted );
+        std::sort( sorted, sorted + used, ByCount );
+
+        out<<"Top PCs by "<<what<<" (total "<<total<<")"<<endl;
+        for( UINT32 ii = 0; ii < used && ii < topN; ii++ )
+        {
+            out<<"  "<<ii<<": PC 0x"<<hex<<sorted[ii].PC<<dec
+               <<"  "<<sorted[ii].count<<" (+/- "<<sorted[ii].error<<")"<<endl;
+        }
+
+        delete [] sorted;
+        return out;
+    }
+};
+
+class REPL_PROFILER
+{
+  private:
+    UINT32 numsets;
+    UINT64 *setMisses;
+    UINT64 *setEvictions;
+    SPACE_SAVING_SKETCH missPCs;
+    SPACE_SAVING_SKETCH deadPCs;
+
+    REPL_PROFILER( const REPL_PROFILER & );
+    REPL_PROFILER & operator=( const REPL_PROFILER & );
+
+  public:
+    REPL_PROFILER() : numsets(0), setMisses(NULL), setEvictions(NULL) {}
+    ~REPL_PROFILER()
+    {
+        delete [] setMisses;
+        delete [] setEvictions;
+    }
+
+    void Init( UINT32 _sets, UINT32 _sketchSlots )
+    {
+        numsets      = _sets;
+        setMisses    = new UINT64[ numsets ];
+        setEvictions = new UINT64[ numsets ];
+        memset( setMisses, 0, numsets * sizeof(UINT64) );
+        memset( setEvictions, 0, numsets * sizeof(UINT64) );
+        missPCs.Init( _sketchSlots );
+        deadPCs.Init( _sketchSlots );
+    }
+
+    void RecordMiss( UINT32 setIndex, Addr_t PC )
+    {
+        setMisses[ setIndex ]++;
+        missPCs.Add( PC );
+    }
+
+    void RecordEviction( UINT32 setIndex, Addr_t fillPC, bool reused )
+    {
+        setEvictions[ setIndex ]++;
+        if( !reused ) deadPCs.Add( fillPC );
+    }
+
+    // One row per set, suitable for plotting as a heatmap
+    ostream & PrintHeatmap( ostream &out ) const
+    {
+        out<<"set,misses,evictions"<<endl;
+        for( UINT32 setIndex = 0; setIndex < numsets; setIndex++ )
+        {
+            out<<setIndex<<","<<setMisses[setIndex]<<","<<setEvictions[setIndex]<<endl;
+        }
+        return out;
+    }
+
+    ostream & PrintTop( ostream &out, UINT32 topN ) const
+    {
+        missPCs.PrintTop( out, "misses", topN );
+        deadPCs.PrintTop( out, "dead-on-arrival lines", topN );
+        return out;
+    }
+};
+
+#endif
@@ -38,43 +38,217 @@ CACHE_REPLACEMENT_STATE::CACHE_REPLACEMENT_STATE( UINT32 _sets, UINT32 _assoc, U
     replPolicy = _pol;
 
     mytimer    = 0;
+    randState  = 1;
+
+    // SHiP configuration survives re-initialization, see SetSHiPConfig
+    NumSHCTTables  = 1;
+    SHiPSigType    = SHIP_SIG_PC;
+    SHiPRegionBits = SHIP_DEFAULT_REGION_BITS;
+
+    // interval sampler is off until SetSampleInterval is called, and keeps
+    // running across re-initialization
+    SampleInterval = 0;
+    NextSample = 0;
+    sampler    = NULL;
+#ifdef REPL_PROFILE
+    profiler   = NULL;
+#endif
 
     InitReplacementState();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
-// This function initializes the replacement policy hardware by creating      //
-// storage for the replacement state on a per-line/per-cache basis.           //
+// Teardown and moves. All policy state lives in the arena, so releasing it   //
+// is one free/munmap. Moves swap: a move-constructed source is left empty,   //
+// a move-assigned source holds the target's old state and frees it when      //
+// destroyed. Either way it may only be destroyed or assigned to.             //
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
-void CACHE_REPLACEMENT_STATE::InitReplacementState()
+CACHE_REPLACEMENT_STATE::~CACHE_REPLACEMENT_STATE()
 {
-    // Create the state for sets, then create the state for the ways
-    repl  = new LINE_REPLACEMENT_STATE* [ numsets ];
+    ReleaseReplacementState();
+    delete sampler;
+}
 
-    // ensure that we were able to create replacement state
-    assert(repl);
+#if __cplusplus >= 201103L
+// Starts from an empty, fully value-initialized state so that Swap hands
+// other nothing indeterminate
+CACHE_REPLACEMENT_STATE::CACHE_REPLACEMENT_STATE( CACHE_REPLACEMENT_STATE &&other )
+    : numsets(0), assoc(0), replPolicy(CRC_REPL_LRU),
+      hitpolicy(0), RRIP_MAX(0), NumLeaderSets(0), PSEL_MAX(0), PSEL(0), BRRIP_rate(0),
+      NumSHCTEntries(0), NumSigBits(0), NumSHCTCtrBits(0), NumSHCTTables(0),
+      SHiPSigType(0), SHiPRegionBits(0), SHiPPathHist(0),
+      Alpha(0), NumEAFEntry(0), AddrCounter(0), EAF(NULL), Hash_a(NULL), Hash_b(NULL), NumHash(0),
+      repl(NULL), validWays(NULL), mytimer(0), randState(0),
+      SampleInterval(0), NextSample(0), sampler(NULL), sampleTotals(),
+#ifdef REPL_PROFILE
+      profiler(NULL),
+#endif
+      stat_Hits(0), stat_Misses(0), stat_ColdFills(0), stat_ReplMisses(0),
+      stat_DRRIP_BL(0), stat_DRRIP_SL(0), stat_DRRIP_BI(0), stat_DRRIP_SI(0),
+      stat_SHiP_BI(0), stat_SHiP_GI(0), stat_SHiP_PredCorrect(0), stat_SHiP_PredTotal(0),
+      stat_EAF_LSI(0), stat_EAF_LBI(0), stat_EAF_SBI(0), stat_EAF_SGI(0),
+      stat_EAF_BBI(0), stat_EAF_BGI(0)
+{
+    Swap( other );
+}
 
-    if (this->replPolicy == CRC_REPL_SRRIP) {
-        hitpolicy = 0; //Use hit RRPV to 0 as default
-        RRIP_MAX = 4; //0,1,2,3
-    }
-    else if (this->replPolicy == CRC_REPL_DRRIP) {
-        hitpolicy = 0; 
-        RRIP_MAX = 4; 
+CACHE_REPLACEMENT_STATE & CACHE_REPLACEMENT_STATE::operator=( CACHE_REPLACEMENT_STATE &&other )
+{
+    // other takes our old state and frees it when it is destroyed
+    if( this != &other ) Swap( other );
+    return *this;
+}
+#endif
+
+void CACHE_REPLACEMENT_STATE::Swap( CACHE_REPLACEMENT_STATE &other )
+{
+    std::swap( numsets, other.numsets );
+    std::swap( assoc, other.assoc );
+    std::swap( replPolicy, other.replPolicy );
+
+    std::swap( hitpolicy, other.hitpolicy );
+    std::swap( RRIP_MAX, other.RRIP_MAX );
+    std::swap( NumLeaderSets, other.NumLeaderSets );
+    std::swap( PSEL_MAX, other.PSEL_MAX );
+    std::swap( PSEL, other.PSEL );
+    std::swap( BRRIP_rate, other.BRRIP_rate );
+
+    std::swap( NumSHCTEntries, other.NumSHCTEntries );
+    std::swap( NumSigBits, other.NumSigBits );
+    std::swap( NumSHCTCtrBits, other.NumSHCTCtrBits );
+    std::swap( NumSHCTTables, other.NumSHCTTables );
+    std::swap( SHiPSigType, other.SHiPSigType );
+    std::swap( SHiPRegionBits, other.SHiPRegionBits );
+    std::swap( SHiPPathHist, other.SHiPPathHist );
+    for (UINT32 tt = 0; tt < SHIP_MAX_TABLES; tt++)
+    {
+        std::swap( SHCT[tt], other.SHCT[tt] );
     }
-    else if (this->replPolicy == CRC_REPL_SHiP)
+
+    std::swap( Alpha, other.Alpha );
+    std::swap( NumEAFEntry, other.NumEAFEntry );
+    std::swap( AddrCounter, other.AddrCounter );
+    std::swap( EAF, other.EAF );
+    std::swap( Hash_a, other.Hash_a );
+    std::swap( Hash_b, other.Hash_b );
+    std::swap( NumHash, other.NumHash );
+
+    arena.Swap( other.arena );
+    std::swap( repl, other.repl );
+    std::swap( validWays, other.validWays );
+
+    std::swap( mytimer, other.mytimer );
+    std::swap( randState, other.randState );
+
+    std::swap( SampleInterval, other.SampleInterval );
+    std::swap( NextSample, other.NextSample );
+    std::swap( sampler, other.sampler );
+    std::swap( sampleTotals, other.sampleTotals );
+#ifdef REPL_PROFILE
+    std::swap( profiler, other.profiler );
+#endif
+
+    std::swap( stat_Hits, other.stat_Hits );
+    std::swap( stat_Misses, other.stat_Misses );
+    std::swap( stat_ColdFills, other.stat_ColdFills );
+    std::swap( stat_ReplMisses, other.stat_ReplMisses );
+    std::swap( stat_DRRIP_BL, other.stat_DRRIP_BL );
+    std::swap( stat_DRRIP_SL, other.stat_DRRIP_SL );
+    std::swap( stat_DRRIP_BI, other.stat_DRRIP_BI );
+    std::swap( stat_DRRIP_SI, other.stat_DRRIP_SI );
+    std::swap( stat_SHiP_BI, other.stat_SHiP_BI );
+    std::swap( stat_SHiP_GI, other.stat_SHiP_GI );
+    std::swap( stat_SHiP_PredCorrect, other.stat_SHiP_PredCorrect );
+    std::swap( stat_SHiP_PredTotal, other.stat_SHiP_PredTotal );
+    std::swap( stat_EAF_LSI, other.stat_EAF_LSI );
+    std::swap( stat_EAF_LBI, other.stat_EAF_LBI );
+    std::swap( stat_EAF_SBI, other.stat_EAF_SBI );
+    std::swap( stat_EAF_SGI, other.stat_EAF_SGI );
+    std::swap( stat_EAF_BBI, other.stat_EAF_BBI );
+    std::swap( stat_EAF_BGI, other.stat_EAF_BGI );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Switching policy re-creates the replacement state, so the new policy gets  //
+// exactly the tables it needs. State and stats start over, an active        //
+// interval sampler keeps its ring and continues from the switch.             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+void CACHE_REPLACEMENT_STATE::SetReplacementPolicy( UINT32 _pol )
+{
+    if( _pol == replPolicy ) return;
+
+    ReleaseReplacementState();
+    replPolicy = _pol;
+    InitReplacementState();
+}
+
+bool CACHE_REPLACEMENT_STATE::SetSHiPConfig( UINT32 _sigType, UINT32 _numTables, UINT32 _regionBits )
+{
+    if( _sigType > SHIP_SIG_PC_MEM ) return false;
+    if( _numTables == 0 || _numTables > SHIP_MAX_TABLES ) return false;
+    if( _regionBits < 6 || _regionBits > 63 ) return false;
+
+    SHiPSigType    = _sigType;
+    NumSHCTTables  = _numTables;
+    SHiPRegionBits = _regionBits;
+
+    // the SHCT tables are carved from the arena, re-plan it for the new count
+    if( replPolicy == CRC_REPL_SHiP )
     {
-        RRIP_MAX = 4;
-        hitpolicy = 0;
+        ReleaseReplacementState();
+        InitReplacementState();
     }
-    else if (this->replPolicy == CRC_REPL_EAF)
+    return true;
+}
+
+void CACHE_REPLACEMENT_STATE::ReleaseReplacementState()
+{
+    arena.Release();
+    repl      = NULL;
+    validWays = NULL;
+    EAF       = NULL;
+    Hash_a    = NULL;
+    Hash_b    = NULL;
+    for (UINT32 tt = 0; tt < SHIP_MAX_TABLES; tt++)
     {
-        RRIP_MAX = 4;
-        hitpolicy = 0;
+        SHCT[tt] = SAT_COUNTER_TABLE();
     }
 
+#ifdef REPL_PROFILE
+    delete profiler;
+    profiler = NULL;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// This function initializes the replacement policy hardware by creating      //
+// storage for the replacement state on a per-line/per-cache basis.           //
+// Only the tables of the active policy are created, all from one arena       //
+// block that comes back zeroed.                                              //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+void CACHE_REPLACEMENT_STATE::InitReplacementState()
+{
+    // the valid-way bitmap holds one bit per way
+    assert(assoc <= 64);
+
+    bool useSHiP = (replPolicy == CRC_REPL_SHiP);
+    bool useEAF  = (replPolicy == CRC_REPL_EAF);
+
+    stat_Hits = 0;
+    stat_Misses = 0;
+    stat_ColdFills = 0;
+    stat_ReplMisses = 0;
+
+    // RRIP parameters, LRU and RANDOM still need RRIP_MAX for the RRPV reset
+    hitpolicy = 0; //Use hit RRPV to 0 as default
+    RRIP_MAX = 4; //0,1,2,3
+
     // for DRRIP    
     stat_DRRIP_BI = 0;
     stat_DRRIP_SI = 0;
@@ -83,45 +257,23 @@ void CACHE_REPLACEMENT_STATE::InitReplacementState()
     NumLeaderSets = 32; // as shown on the paper
     BRRIP_rate = 16;
     PSEL_MAX = 1024;
-    PSEL = PSEL/2; //starting from a mid point
+    PSEL = PSEL_MAX/2; //starting from a mid point
 
     // for SHiP
     NumSHCTEntries = 16*1024; 
     NumSigBits = 14;
     NumSHCTCtrBits = 3; 
-    // set up the SHCTable
-    SHCT = new UINT32[NumSHCTEntries];
-    for (UINT32 ii = 0; ii < NumSHCTEntries; ii++)
-    {
-        SHCT[ii] = 0;
-    }
+    SHiPPathHist = 0;
     stat_SHiP_BI = 0;
     stat_SHiP_GI = 0;
+    stat_SHiP_PredCorrect = 0;
+    stat_SHiP_PredTotal = 0;
 
     // for EAF
     Alpha = 8;
     NumEAFEntry = 8 * 1024 * 16; // m = alpha * #cacheblocks (alpha = 8) 
     AddrCounter = 0; // counter of number of addresses
-    EAF = new UINT32[NumEAFEntry];
-    for (UINT32 ii = 0; ii < NumEAFEntry; ii++)
-    {
-        EAF[ii] = 0;
-    }
     NumHash = 2;
-    // Create the hash table (2^64 --> 2^17 space)
-    // To implement H3 we need 2 (64 * 17) tables.
-    // which means we need 64 random 2^17 numbers for each tables.
-    Hash_a = new UINT32[64];
-    Hash_b = new UINT32[64];
-
-    for(UINT32 ii = 0; ii < 64; ii++)
-    {
-        Hash_a[ii] = rand()% (32576 * 4); // since the maximum pseduo random number is 32576 which 2^15 we need 2^17
-    }
-    for(UINT32 ii = 0; ii < 64; ii++)
-    {
-        Hash_b[ii] = rand()% (32576 * 4); // since the maximum pseduo random number is 32576 which 2^15 we need 2^17
-    }
     stat_EAF_SBI = 0; //EAF bad insert static
     stat_EAF_SGI = 0; //EAF good insert static
 
@@ -131,10 +283,68 @@ void CACHE_REPLACEMENT_STATE::InitReplacementState()
     stat_EAF_LSI = 0; //leader set static insert
     stat_EAF_LBI = 0; //leader set bypass insert
 
-    // Create the state for the sets
+    // Size everything the policy needs, then carve it in the same order
+    arena.Plan( numsets * sizeof(LINE_REPLACEMENT_STATE *) );
+    arena.Plan( (size_t) numsets * assoc * sizeof(LINE_REPLACEMENT_STATE) );
+    arena.Plan( numsets * sizeof(UINT64) );
+    if (useSHiP)
+    {
+        for (UINT32 tt = 0; tt < NumSHCTTables; tt++)
+        {
+            arena.Plan( SAT_COUNTER_TABLE::BytesFor(NumSHCTEntries, NumSHCTCtrBits) );
+        }
+    }
+    if (useEAF)
+    {
+        arena.Plan( NumEAFEntry * sizeof(UINT32) );
+        arena.Plan( 64 * sizeof(UINT32) );
+        arena.Plan( 64 * sizeof(UINT32) );
+    }
+    arena.Reserve();
+
+    // Create the state for sets, then create the state for the ways
+    repl  = (LINE_REPLACEMENT_STATE **) arena.Alloc( numsets * sizeof(LINE_REPLACEMENT_STATE *) );
+    LINE_REPLACEMENT_STATE *lines = (LINE_REPLACEMENT_STATE *) arena.Alloc( (size_t) numsets * assoc * sizeof(LINE_REPLACEMENT_STATE) );
+    validWays = (UINT64 *) arena.Alloc( numsets * sizeof(UINT64) );
+
+    // ensure that we were able to create replacement state
+    assert(repl);
+
+    // set up the SHCTable, counters are packed two per byte
+    if (useSHiP)
+    {
+        for (UINT32 tt = 0; tt < NumSHCTTables; tt++)
+        {
+            UINT32 bytes = SAT_COUNTER_TABLE::BytesFor(NumSHCTEntries, NumSHCTCtrBits);
+            SHCT[tt].Init(NumSHCTEntries, NumSHCTCtrBits, (UINT8 *) arena.Alloc(bytes));
+        }
+    }
+
+    if (useEAF)
+    {
+        EAF = (UINT32 *) arena.Alloc( NumEAFEntry * sizeof(UINT32) );
+        // Create the hash table (2^64 --> 2^17 space)
+        // To implement H3 we need 2 (64 * 17) tables.
+        // which means we need 64 random 2^17 numbers for each tables.
+        Hash_a = (UINT32 *) arena.Alloc( 64 * sizeof(UINT32) );
+        Hash_b = (UINT32 *) arena.Alloc( 64 * sizeof(UINT32) );
+
+        for(UINT32 ii = 0; ii < 64; ii++)
+        {
+            Hash_a[ii] = Rand()% (32576 * 4); // since the maximum pseduo random number is 32576 which 2^15 we need 2^17
+        }
+        for(UINT32 ii = 0; ii < 64; ii++)
+        {
+            Hash_b[ii] = Rand()% (32576 * 4); // since the maximum pseduo random number is 32576 which 2^15 we need 2^17
+        }
+    }
+
+    // Create the state for the sets. The arena is zeroed, so only the
+    // non-zero fields are written (SHiP signatures, flags and the valid-way
+    // bitmap all start at 0).
     for(UINT32 setIndex=0; setIndex<numsets; setIndex++) 
     {
-        repl[ setIndex ]  = new LINE_REPLACEMENT_STATE[ assoc ];
+        repl[ setIndex ]  = lines + (size_t) setIndex * assoc;
 
         for(UINT32 way=0; way<assoc; way++) 
         {
@@ -142,12 +352,18 @@ void CACHE_REPLACEMENT_STATE::InitReplacementState()
             repl[ setIndex ][ way ].LRUstackposition = way;
             // for SRRIP
             repl[ setIndex ][ way ].RRPV = RRIP_MAX - 1;
-            // for SHiP
-            repl[ setIndex ][ way ].signature_m = 0;
-            repl[ setIndex ][ way ].outcome = false;
         }
     }
 
+    // the stats restart at 0, so a running sampler measures from here
+    MarkSampleBaseline();
+
+#ifdef REPL_PROFILE
+    // records from the first miss, so it is not deferred like the sampler
+    profiler = new REPL_PROFILER;
+    profiler->Init( numsets, REPL_PROFILER_SKETCH_SLOTS );
+#endif
+
     // Contestants:  ADD INITIALIZATION FOR YOUR HARDWARE HERE
 
 }
@@ -170,6 +386,15 @@ void CACHE_REPLACEMENT_STATE::InitReplacementState()
 INT32 CACHE_REPLACEMENT_STATE::GetVictimInSet( UINT32 tid, UINT32 setIndex, const LINE_STATE *vicSet, UINT32 assoc,
                                                Addr_t PC, Addr_t paddr, UINT32 accessType )
 {
+    // Fill an invalid way first, no policy state needs to be aged for it
+    INT32 invalidWay = Get_Invalid_Way( setIndex, vicSet );
+    if( invalidWay >= 0 )
+    {
+        stat_ColdFills++;
+        return invalidWay;
+    }
+    stat_ReplMisses++;
+
     // If no invalid lines, then replace based on replacement policy
     if( replPolicy == CRC_REPL_LRU ) 
     {
@@ -220,6 +445,30 @@ void CACHE_REPLACEMENT_STATE::UpdateReplacementState(
     UINT32 setIndex, INT32 updateWayID, const LINE_STATE *currLine, 
     UINT32 tid, Addr_t PC, UINT32 accessType, bool cacheHit )
 {
+    // Keep the valid-way bitmap in sync with the line just touched
+    if( currLine->valid ) validWays[ setIndex ] |= (1ULL << updateWayID);
+    else validWays[ setIndex ] &= ~(1ULL << updateWayID);
+
+    if( cacheHit ) stat_Hits++;
+    else stat_Misses++;
+
+#ifdef REPL_PROFILE
+    // on a miss the way still describes the line being evicted
+    LINE_REPLACEMENT_STATE &profLine = repl[ setIndex ][ updateWayID ];
+    if( cacheHit )
+    {
+        profLine.reused = true;
+    }
+    else
+    {
+        profiler->RecordMiss( setIndex, PC );
+        if( profLine.filled ) profiler->RecordEviction( setIndex, profLine.fillPC, profLine.reused );
+        profLine.fillPC = PC;
+        profLine.filled = true;
+        profLine.reused = false;
+    }
+#endif
+
     // What replacement policy?
     if( replPolicy == CRC_REPL_LRU ) 
     {
@@ -239,7 +488,7 @@ void CACHE_REPLACEMENT_STATE::UpdateReplacementState(
     }
     else if( replPolicy == CRC_REPL_SHiP )
     {
-        UpdateSHiP( setIndex, updateWayID, cacheHit, PC);
+        UpdateSHiP( setIndex, updateWayID, cacheHit, PC, currLine);
     }
     else if( replPolicy == CRC_REPL_EAF )
     {
@@ -250,7 +499,7 @@ void CACHE_REPLACEMENT_STATE::UpdateReplacementState(
         
     }
     
-    
+    if( SampleInterval && mytimer >= NextSample ) TakeSample();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -260,6 +509,42 @@ void CACHE_REPLACEMENT_STATE::UpdateReplacementState(
 ////////////////////////////////////////////////////////////////////////////////
 
 
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// This function returns an invalid way of the set, or -1 if the set is full. //
+// vicSet is the authority, the bitmap only finds candidates fast. It can be  //
+// stale both ways: a line filled without an update still looks invalid, and  //
+// a line the cache invalidated without calling InvalidateWay (a flush or a   //
+// back-invalidation) still looks valid. So each candidate is checked, and a  //
+// set the bitmap calls full is confirmed against vicSet before the policy    //
+// picks a victim, clearing any stale bit.                                    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+INT32 CACHE_REPLACEMENT_STATE::Get_Invalid_Way( UINT32 setIndex, const LINE_STATE *vicSet )
+{
+    UINT64 allWays = (assoc == 64) ? ~0ULL : ((1ULL << assoc) - 1);
+    UINT64 invalid = ~validWays[ setIndex ] & allWays;
+
+    while( invalid )
+    {
+        INT32 way = __builtin_ctzll( invalid );
+        if( !vicSet[way].valid ) return way;
+
+        validWays[ setIndex ] |= (1ULL << way);
+        invalid &= invalid - 1;
+    }
+
+    for( UINT32 way = 0; way < assoc; way++ )
+    {
+        if( !vicSet[way].valid )
+        {
+            validWays[ setIndex ] &= ~(1ULL << way);
+            return way;
+        }
+    }
+    return -1;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
 // This function finds the LRU victim in the cache set by returning the       //
@@ -341,6 +626,32 @@ INT32 CACHE_REPLACEMENT_STATE::Get_EAF_Victim( UINT32 setIndex , const LINE_STAT
     return FoundWay;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Per-instance stand-in for rand(), same 31-bit range. The shared libc state //
+// made results depend on how concurrent instances interleaved. RANDOM, BRRIP //
+// and the EAF hashes draw from it, so their results depend on the seed set   //
+// with SetRandomSeed, and srand() no longer affects them.                    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+UINT32 CACHE_REPLACEMENT_STATE::Rand()
+{
+    randState = randState * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (UINT32) (randState >> 33);
+}
+
+void CACHE_REPLACEMENT_STATE::SetRandomSeed( UINT64 _seed )
+{
+    randState = _seed;
+
+    // the H3 hashes were drawn at init, draw them again from this seed
+    if( replPolicy == CRC_REPL_EAF )
+    {
+        ReleaseReplacementState();
+        InitReplacementState();
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
 // This function finds a random victim in the cache set                       //
@@ -348,7 +659,7 @@ INT32 CACHE_REPLACEMENT_STATE::Get_EAF_Victim( UINT32 setIndex , const LINE_STAT
 ////////////////////////////////////////////////////////////////////////////////
 INT32 CACHE_REPLACEMENT_STATE::Get_Random_Victim( UINT32 setIndex )
 {
-    INT32 way = (rand() % assoc);
+    INT32 way = (Rand() % assoc);
     
     return way;
 }
@@ -416,7 +727,7 @@ void CACHE_REPLACEMENT_STATE::UpdateBRRIP( UINT32 setIndex, INT32 updateWayID, b
     }
     else // if MISS install on a 1/freq chance to RRIP_MAX - 3
     {
-        UINT32 randnum = rand() % BRRIP_rate; // rand 0 ~ freq-1
+        UINT32 randnum = Rand() % BRRIP_rate; // rand 0 ~ freq-1
         if (randnum == BRRIP_rate-1) 
         {
             replSet[updateWayID].RRPV = RRIP_MAX - 2; // infrequent pattern
@@ -470,52 +781,107 @@ void CACHE_REPLACEMENT_STATE::UpdateDRRIP( UINT32 setIndex, INT32 updateWayID, b
 
 }
 
-void   CACHE_REPLACEMENT_STATE::UpdateSHiP( UINT32 setIndex, INT32 updateWayID, bool cacheHit,  Addr_t PC) 
+UINT32 CACHE_REPLACEMENT_STATE::SHiP_Signature( UINT32 setIndex, Addr_t PC, const LINE_STATE *currLine )
+{
+    // The signature is kept wide here, SHiP_Index folds it per table.
+    UINT32 pcsig = (UINT32) (PC >> 2);
+    Addr_t memaddr = (((currLine->tag)*numsets)<<6) + (setIndex<<6);
+    UINT32 memsig = (UINT32) (memaddr >> SHiPRegionBits);
+
+    if (SHiPSigType == SHIP_SIG_MEM)
+    {
+        return memsig;
+    }
+    else if (SHiPSigType == SHIP_SIG_PC_PATH)
+    {
+        return pcsig ^ SHiPPathHist;
+    }
+    else if (SHiPSigType == SHIP_SIG_PC_MEM)
+    {
+        return pcsig ^ (memsig * 0x9E3779B1u);
+    }
+    return pcsig;
+}
+
+UINT32 CACHE_REPLACEMENT_STATE::SHiP_Index( UINT32 signature, UINT32 table )
+{
+    // Table 0 keeps the plain low signature bits, the other tables use a
+    // different multiplicative hash each so that two signatures colliding in
+    // one table rarely collide in all of them.
+    static const UINT32 skew[SHIP_MAX_TABLES] = { 1, 0x9E3779B1u, 0x85EBCA77u, 0xC2B2AE3Du };
+    UINT32 mask = (1 << NumSigBits) - 1;
+    if (table == 0) return signature & mask;
+
+    UINT32 hashed = signature * skew[table];
+    return (hashed >> (32 - NumSigBits)) & mask;
+}
+
+bool CACHE_REPLACEMENT_STATE::SHiP_PredictDead( UINT32 signature )
+{
+    // Count-min style: the least trained table is the least aliased one.
+    for (UINT32 tt = 0; tt < NumSHCTTables; tt++)
+    {
+        if (SHCT[tt].Get(SHiP_Index(signature, tt)) == 0) return true;
+    }
+    return false;
+}
+
+void   CACHE_REPLACEMENT_STATE::UpdateSHiP( UINT32 setIndex, INT32 updateWayID, bool cacheHit,  Addr_t PC, const LINE_STATE *currLine ) 
 {
     LINE_REPLACEMENT_STATE *replSet = repl[ setIndex ];
-    // Find the Hash entry first 
-    // Use the 2~15 bit of PC as HASH entry
-    UINT32 SHCTindex = PC;
-    SHCTindex = SHCTindex >> 2;
-    SHCTindex = SHCTindex & ((1 << NumSigBits) - 1);
-
-    UINT32 indmax = 1 << NumSigBits;
-    assert(SHCTindex < indmax);
-    // end
-    UINT32 SHCT_MAX = 1 << NumSHCTCtrBits;
-    UINT32 currsig =  replSet[updateWayID].signature_m;
+    UINT32 currsig = SHiP_Signature(setIndex, PC, currLine);
 
     if (cacheHit)
     {
+        // train the signature that brought the line in
+        if (replSet[updateWayID].sigValid)
+        {
+            for (UINT32 tt = 0; tt < NumSHCTTables; tt++)
+            {
+                SHCT[tt].Increment(SHiP_Index(replSet[updateWayID].signature_m, tt));
+            }
+        }
         replSet[updateWayID].outcome = true;
-        if(SHCT[SHCTindex] <= SHCT_MAX) SHCT[SHCTindex]++;
-
         replSet[updateWayID].RRPV = 0;
     }
     else 
     {
-        //decrement SHCT counter
-        if (!replSet[updateWayID].outcome)
+        // the previous line in this way is being evicted
+        if (replSet[updateWayID].sigValid)
         {
-            if(SHCT[currsig] > 0) SHCT[currsig]--;
+            UINT32 evictsig = replSet[updateWayID].signature_m;
+            if (!replSet[updateWayID].outcome)
+            {
+                for (UINT32 tt = 0; tt < NumSHCTTables; tt++)
+                {
+                    SHCT[tt].Decrement(SHiP_Index(evictsig, tt));
+                }
+            }
+            stat_SHiP_PredTotal++;
+            if (replSet[updateWayID].predictedDead != replSet[updateWayID].outcome) stat_SHiP_PredCorrect++;
         }
 
         replSet[updateWayID].outcome = false;
-        replSet[updateWayID].signature_m = SHCTindex;
+        replSet[updateWayID].signature_m = currsig;
+        replSet[updateWayID].sigValid = true;
 
         //insert based on signature
-        if (SHCT[SHCTindex] == 0)
+        if (SHiP_PredictDead(currsig))
         {
             replSet[updateWayID].RRPV = RRIP_MAX - 1;
+            replSet[updateWayID].predictedDead = true;
             stat_SHiP_BI ++;
         }
         else
         {
             replSet[updateWayID].RRPV = RRIP_MAX - 2;
+            replSet[updateWayID].predictedDead = false;
             stat_SHiP_GI ++;
         }
     }
 
+    // fold this access into the path history after it has been used
+    SHiPPathHist = ((SHiPPathHist << 3) ^ (UINT32) (PC >> 2)) & ((1 << NumSigBits) - 1);
 }
 
 UINT32   CACHE_REPLACEMENT_STATE::EAF_hash_a (Addr_t memaddr)
@@ -588,7 +954,7 @@ void   CACHE_REPLACEMENT_STATE::UpdateBEAF( UINT32 setIndex, INT32 updateWayID,
     }
     else // if miss try to find the EAF to determine the insert position
     {
-        if ((EAF[EAF_hash_a(memaddr)]) && (EAF[EAF_hash_b(memaddr)]) && (rand()%10 <= 2))
+        if ((EAF[EAF_hash_a(memaddr)]) && (EAF[EAF_hash_b(memaddr)]) && (Rand()%10 <= 2))
         {
             replSet[updateWayID].RRPV = RRIP_MAX - 2;
             stat_EAF_BGI++;
@@ -664,6 +1030,100 @@ void   CACHE_REPLACEMENT_STATE::UpdateEAF( UINT32 setIndex, INT32 updateWayID, b
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// The interval sampler records PSEL, hit/miss counts, EAF fill level and the //
+// insertion class mix every SampleInterval accesses. The ring is allocated   //
+// here once, taking a sample only copies counters into the next slot.        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+void CACHE_REPLACEMENT_STATE::SetSampleInterval( UINT64 _interval, UINT32 _ringSize )
+{
+    SampleInterval = _interval;
+    NextSample = mytimer + _interval;
+    if( _interval )
+    {
+        if( !sampler ) sampler = new INTERVAL_SAMPLER;
+        sampler->Init( _ringSize );
+    }
+
+    MarkSampleBaseline();
+}
+
+// intervals are measured from the current counts
+void CACHE_REPLACEMENT_STATE::MarkSampleBaseline()
+{
+    sampleTotals.timer = mytimer;
+    sampleTotals.hits = stat_Hits;
+    sampleTotals.misses = stat_Misses;
+    sampleTotals.insSRRIP = stat_DRRIP_SI + stat_DRRIP_BL;
+    sampleTotals.insBRRIP = stat_DRRIP_BI + stat_DRRIP_SL;
+    sampleTotals.insSHiPGood = stat_SHiP_GI;
+    sampleTotals.insSHiPBad = stat_SHiP_BI;
+    sampleTotals.insEAFGood = stat_EAF_SGI + stat_EAF_BGI;
+    sampleTotals.insEAFBad = stat_EAF_SBI + stat_EAF_BBI;
+}
+
+void CACHE_REPLACEMENT_STATE::TakeSample()
+{
+    INTERVAL_SAMPLE &s = sampler->Next();
+
+    // the DRRIP leader stats count misses in the leader sets, which are
+    // also insertions of that leader's policy
+    UINT64 insSRRIP = stat_DRRIP_SI + stat_DRRIP_BL;
+    UINT64 insBRRIP = stat_DRRIP_BI + stat_DRRIP_SL;
+    UINT64 insEAFGood = stat_EAF_SGI + stat_EAF_BGI;
+    UINT64 insEAFBad = stat_EAF_SBI + stat_EAF_BBI;
+
+    s.timer = mytimer;
+    s.hits = stat_Hits - sampleTotals.hits;
+    s.misses = stat_Misses - sampleTotals.misses;
+    s.psel = PSEL;
+    s.eafFill = AddrCounter;
+    s.insSRRIP = insSRRIP - sampleTotals.insSRRIP;
+    s.insBRRIP = insBRRIP - sampleTotals.insBRRIP;
+    s.insSHiPGood = stat_SHiP_GI - sampleTotals.insSHiPGood;
+    s.insSHiPBad = stat_SHiP_BI - sampleTotals.insSHiPBad;
+    s.insEAFGood = insEAFGood - sampleTotals.insEAFGood;
+    s.insEAFBad = insEAFBad - sampleTotals.insEAFBad;
+
+    sampleTotals.hits = stat_Hits;
+    sampleTotals.misses = stat_Misses;
+    sampleTotals.insSRRIP = insSRRIP;
+    sampleTotals.insBRRIP = insBRRIP;
+    sampleTotals.insSHiPGood = stat_SHiP_GI;
+    sampleTotals.insSHiPBad = stat_SHiP_BI;
+    sampleTotals.insEAFGood = insEAFGood;
+    sampleTotals.insEAFBad = insEAFBad;
+
+    NextSample = mytimer + SampleInterval;
+}
+
+ostream & CACHE_REPLACEMENT_STATE::PrintIntervals( ostream &out, bool json )
+{
+    // samples stay printable after SetSampleInterval(0) stops sampling
+    if( !sampler ) return out;
+    return json ? sampler->PrintJSON( out ) : sampler->PrintCSV( out );
+}
+
+ostream & CACHE_REPLACEMENT_STATE::PrintProfileHeatmap( ostream &out )
+{
+#ifdef REPL_PROFILE
+    profiler->PrintHeatmap( out );
+#endif
+    return out;
+}
+
+ostream & CACHE_REPLACEMENT_STATE::PrintProfileTop( ostream &out, UINT32 topN )
+{
+#ifdef REPL_PROFILE
+    profiler->PrintTop( out, topN );
+#else
+    (void) topN;
+#endif
+    return out;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //                                                                            //
 // The function prints the statistics for the cache                           //
@@ -678,6 +1138,10 @@ ostream & CACHE_REPLACEMENT_STATE::PrintStats(ostream &out)
 
     // CONTESTANTS:  Insert your statistics printing here
 
+    out<<"Cold fills (invalid way):   "<<stat_ColdFills<<endl;
+    out<<"Replacement misses:         "<<stat_ReplMisses<<endl;
+    out<<"Hits:                       "<<stat_Hits<<endl;
+    out<<"Misses:                     "<<stat_Misses<<endl;
     out<<"leader sets using SRRIP:    "<<stat_DRRIP_SL<<endl;
     out<<"leader sets using BRRIP:    "<<stat_DRRIP_BL<<endl;
     out<<"Following sets using SRRIP: "<<stat_DRRIP_SI<<endl;
@@ -685,6 +1149,12 @@ ostream & CACHE_REPLACEMENT_STATE::PrintStats(ostream &out)
     out<<"=================SHiP======================="<<endl;
     out<<"SHiP GOOD INSERT: "<<stat_SHiP_GI<<endl;
     out<<"SHiP BAD  INSERT: "<<stat_SHiP_BI<<endl;
+    out<<"SHiP PREDICTIONS CHECKED: "<<stat_SHiP_PredTotal<<endl;
+    out<<"SHiP PREDICTION ACCURACY: "
+       <<(stat_SHiP_PredTotal ? (100.0 * stat_SHiP_PredCorrect / stat_SHiP_PredTotal) : 0.0)<<"%"<<endl;
+    out<<"SHiP SIGNATURE TYPE: "<<SHiPSigNames[ SHiPSigType ]<<endl;
+    out<<"SHiP SHCT TABLES: "<<NumSHCTTables<<endl;
+    out<<"SHiP SHCT BYTES: "<<NumSHCTTables * SHCT[0].Bytes()<<endl;
     out<<"=================EAF======================="<<endl;
     out<<"EAF Leader Static INSERT: "<<stat_EAF_LSI<<endl;
     out<<"EAF Leader Bypass INSERT: "<<stat_EAF_LBI<<endl;
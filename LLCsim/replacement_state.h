@@ -21,6 +21,12 @@
 #include <iostream>
 #include "utils.h"
 #include "crc_cache_defs.h"
+#include "sat_counter_table.h"
+#include "interval_sampler.h"
+#include "repl_arena.h"
+#ifdef REPL_PROFILE
+#include "repl_profiler.h"
+#endif
 
 // Replacement Policies Supported
 typedef enum 
@@ -34,6 +40,21 @@ typedef enum
     CRC_REPL_CUSTOM     = 6
 } ReplacemntPolicy;
 
+// SHiP signature sources
+typedef enum
+{
+    SHIP_SIG_PC         = 0,    // PC bits [2:..]
+    SHIP_SIG_MEM        = 1,    // memory region of the line
+    SHIP_SIG_PC_PATH    = 2,    // PC xor recent PC path history
+    SHIP_SIG_PC_MEM     = 3     // PC xor memory region
+} SHiPSignatureType;
+
+// Short names of the signature sources, indexed by SHiPSignatureType
+static const char * const SHiPSigNames[] = { "pc", "mem", "path", "pcmem" };
+
+#define SHIP_MAX_TABLES 4
+#define SHIP_DEFAULT_REGION_BITS 14     // 16KB regions
+
 // Replacement State Per Cache Line
 typedef struct
 {
@@ -43,6 +64,13 @@ typedef struct
     // for SHiP
     UINT32  signature_m;
     bool    outcome;
+    bool    sigValid;       // line was filled under SHiP and owns signature_m
+    bool    predictedDead;  // SHCT prediction made at fill time
+#ifdef REPL_PROFILE
+    Addr_t  fillPC;         // PC that brought the line in
+    bool    filled;         // way holds a line filled through an update
+    bool    reused;         // line has hit since it was filled
+#endif
 
     // CONTESTANTS: Add extra state per cache line here
 
@@ -70,7 +98,11 @@ class CACHE_REPLACEMENT_STATE
     UINT32 NumSHCTEntries;
     UINT32 NumSigBits;
     UINT32 NumSHCTCtrBits;
-    UINT32 *SHCT;
+    UINT32 NumSHCTTables;   // >1 enables skewed lookup, one hash per table
+    UINT32 SHiPSigType;
+    UINT32 SHiPRegionBits;  // log2 of the memory region size for SHIP_SIG_MEM
+    UINT32 SHiPPathHist;    // PC path history for SHIP_SIG_PC_PATH
+    SAT_COUNTER_TABLE SHCT[SHIP_MAX_TABLES];
     // For EAF
     UINT32 Alpha;
     UINT32 NumEAFEntry; // m = alpha * #cacheblocks (alpha = 8)
@@ -81,49 +113,107 @@ class CACHE_REPLACEMENT_STATE
     UINT32 NumHash;
 
     
+    REPL_ARENA arena;   // backs repl, validWays, SHCT and the EAF tables
     LINE_REPLACEMENT_STATE   **repl;
+    UINT64 *validWays;  // per-set bitmap of valid ways, bit i is way i
 
     COUNTER mytimer;  // tracks # of references to the cache
+    UINT64  randState; // per-instance generator used in place of rand(), see SetRandomSeed
+
+    // Interval sampler, off while SampleInterval is 0
+    UINT64 SampleInterval;  // accesses (mytimer ticks) per sample
+    UINT64 NextSample;      // mytimer value of the next sample
+    INTERVAL_SAMPLER *sampler;  // allocated on the first SetSampleInterval
+    INTERVAL_SAMPLE  sampleTotals; // cumulative counts at the last sample
+
+#ifdef REPL_PROFILE
+    REPL_PROFILER *profiler;    // created by every InitReplacementState
+#endif
 
     // CONTESTANTS:  Add extra state for cache here
     // below are stats
+    UINT64 stat_Hits;
+    UINT64 stat_Misses;
+    UINT64 stat_ColdFills; // misses filled into an invalid way
+    UINT64 stat_ReplMisses; // misses that needed a policy victim
     // DRRIP
-    UINT32 stat_DRRIP_BL; // BRRIP Leader
-    UINT32 stat_DRRIP_SL; // SRRIP Leader
-    UINT32 stat_DRRIP_BI; // BRRIP insert
-    UINT32 stat_DRRIP_SI; // SRRIP insert
+    UINT64 stat_DRRIP_BL; // BRRIP Leader
+    UINT64 stat_DRRIP_SL; // SRRIP Leader
+    UINT64 stat_DRRIP_BI; // BRRIP insert
+    UINT64 stat_DRRIP_SI; // SRRIP insert
 
-    UINT32 stat_SHiP_BI;
-    UINT32 stat_SHiP_GI;
+    UINT64 stat_SHiP_BI;
+    UINT64 stat_SHiP_GI;
+    UINT64 stat_SHiP_PredCorrect; // evictions where the fill prediction held
+    UINT64 stat_SHiP_PredTotal;   // evictions of lines with a prediction
 
-    UINT32 stat_EAF_LSI; //leader set static insert
-    UINT32 stat_EAF_LBI; //leader set bypass insert
+    UINT64 stat_EAF_LSI; //leader set static insert
+    UINT64 stat_EAF_LBI; //leader set bypass insert
 
-    UINT32 stat_EAF_SBI; //EAF bad insert static
-    UINT32 stat_EAF_SGI; //EAF good insert static
+    UINT64 stat_EAF_SBI; //EAF bad insert static
+    UINT64 stat_EAF_SGI; //EAF good insert static
 
-    UINT32 stat_EAF_BBI; //EAF bad insert bypass
-    UINT32 stat_EAF_BGI; //EAF good insert bypass
+    UINT64 stat_EAF_BBI; //EAF bad insert bypass
+    UINT64 stat_EAF_BGI; //EAF good insert bypass
 
   public:
 
     // The constructor CAN NOT be changed
     CACHE_REPLACEMENT_STATE( UINT32 _sets, UINT32 _assoc, UINT32 _pol );
+    ~CACHE_REPLACEMENT_STATE();
+
+#if __cplusplus >= 201103L
+    CACHE_REPLACEMENT_STATE( CACHE_REPLACEMENT_STATE &&other );
+    CACHE_REPLACEMENT_STATE & operator=( CACHE_REPLACEMENT_STATE &&other );
+#endif
 
     INT32  GetVictimInSet( UINT32 tid, UINT32 setIndex, const LINE_STATE *vicSet, UINT32 assoc, Addr_t PC, Addr_t paddr, UINT32 accessType );
     void   UpdateReplacementState( UINT32 setIndex, INT32 updateWayID );
 
-    void   SetReplacementPolicy( UINT32 _pol ) { replPolicy = _pol; } 
+    void   SetReplacementPolicy( UINT32 _pol );
+
+    // SHiP signature source (SHiPSignatureType), SHCT tables (1 = plain,
+    // 2..SHIP_MAX_TABLES = skewed) and region size for the memory
+    // signatures. Returns false and keeps the old setting if out of range.
+    // Re-creates the SHCT when SHiP is active, so call it before simulating.
+    bool   SetSHiPConfig( UINT32 _sigType, UINT32 _numTables, UINT32 _regionBits );
+
+    // Seeds the per-instance generator behind RANDOM, BRRIP and the EAF
+    // (default 1). Re-creates the EAF so its hashes come from the new seed,
+    // so call it before simulating.
+    void   SetRandomSeed( UINT64 _seed );
     void   IncrementTimer() { mytimer++; } 
+    // Optional hint that the cache invalidated a line. Without it the way is
+    // still found, by the vicSet check when the set looks full.
+    void   InvalidateWay( UINT32 setIndex, UINT32 way ) { validWays[ setIndex ] &= ~(1ULL << way); }
 
     void   UpdateReplacementState( UINT32 setIndex, INT32 updateWayID, const LINE_STATE *currLine, 
                                    UINT32 tid, Addr_t PC, UINT32 accessType, bool cacheHit );
 
     ostream&   PrintStats( ostream &out);
 
+    // Sample every _interval accesses into a ring of _ringSize intervals.
+    // An _interval of 0 stops sampling; the samples taken stay printable.
+    void       SetSampleInterval( UINT64 _interval, UINT32 _ringSize );
+    ostream&   PrintIntervals( ostream &out, bool json );
+
+    // Hot-spot profile, prints nothing unless built with REPL_PROFILE
+    ostream&   PrintProfileHeatmap( ostream &out );
+    ostream&   PrintProfileTop( ostream &out, UINT32 topN );
+
   private:
-    
+
+    // the state owns its tables, copies are not allowed
+    CACHE_REPLACEMENT_STATE( const CACHE_REPLACEMENT_STATE & );
+    CACHE_REPLACEMENT_STATE & operator=( const CACHE_REPLACEMENT_STATE & );
+
     void   InitReplacementState();
+    void   ReleaseReplacementState();
+    void   Swap( CACHE_REPLACEMENT_STATE &other );
+    void   TakeSample();
+    void   MarkSampleBaseline();
+    UINT32 Rand();
+    INT32  Get_Invalid_Way( UINT32 setIndex, const LINE_STATE *vicSet );
     INT32  Get_Random_Victim( UINT32 setIndex );
 
     INT32  Get_LRU_Victim( UINT32 setIndex );
@@ -136,7 +226,10 @@ class CACHE_REPLACEMENT_STATE
     void   UpdateBRRIP( UINT32 setIndex, INT32 updateWayID, bool cacheHit );
     void   UpdateDRRIP( UINT32 setIndex, INT32 updateWayID, bool cacheHit );
 
-    void   UpdateSHiP( UINT32 setIndex, INT32 updateWayID, bool cacheHit,  Addr_t PC);
+    void   UpdateSHiP( UINT32 setIndex, INT32 updateWayID, bool cacheHit,  Addr_t PC, const LINE_STATE *currLine );
+    UINT32 SHiP_Signature( UINT32 setIndex, Addr_t PC, const LINE_STATE *currLine );
+    UINT32 SHiP_Index( UINT32 signature, UINT32 table );
+    bool   SHiP_PredictDead( UINT32 signature );
 
     UINT32   EAF_hash_a (Addr_t memaddr); 
     UINT32   EAF_hash_b (Addr_t memaddr); 
@@ -0,0 +1,96 @@
+#ifndef SAT_COUNTER_TABLE_H
+#define SAT_COUNTER_TABLE_H
+
+/*
+** Packed table of small saturating counters. Counters are stored two (4-bit
+** fields) or four (2-bit fields) per byte, so a 16K entry SHCT with 3-bit
+** counters needs 8KB instead of 64KB of 32-bit words.
+**
+** The counter width (CtrBits) sets the saturation point, the field width is
+** the smallest of 2 or 4 bits that can hold it.
+**
+** The table does not own its storage: the caller sizes it with BytesFor()
+** and passes zeroed memory to Init(), so it can live in the policy arena.
+*/
+
+#include <cstring>
+#include <cassert>
+#include "utils.h"
+
+class SAT_COUNTER_TABLE
+{
+  private:
+    UINT32 numEntries;
+    UINT32 ctrMax;      // saturation value, (1 << ctrBits) - 1
+    UINT32 fieldShift;  // log2 of the field width in bits (1 or 2)
+    UINT32 perByteShift;// log2 of the counters stored per byte (2 or 1)
+    UINT8  fieldMask;
+    UINT8  *data;
+
+    static UINT32 FieldShift( UINT32 ctrBits ) { return (ctrBits <= 2) ? 1 : 2; }
+
+    UINT32 Shift( UINT32 idx ) const
+    {
+        return (idx & ((1 << perByteShift) - 1)) << fieldShift;
+    }
+
+  public:
+    SAT_COUNTER_TABLE() : numEntries(0), ctrMax(0), fieldShift(0),
+                          perByteShift(0), fieldMask(0), data(NULL) {}
+
+    static UINT32 BytesFor( UINT32 _entries, UINT32 _ctrBits )
+    {
+        UINT32 perByteShift = 3 - FieldShift(_ctrBits);
+        return (_entries + (1 << perByteShift) - 1) >> perByteShift;
+    }
+
+    // _storage must hold BytesFor(_entries, _ctrBits) zeroed bytes
+    void Init( UINT32 _entries, UINT32 _ctrBits, UINT8 *_storage )
+    {
+        assert(_ctrBits >= 1 && _ctrBits <= 4);
+        assert(_storage);
+
+        numEntries   = _entries;
+        ctrMax       = (1 << _ctrBits) - 1;
+        fieldShift   = FieldShift(_ctrBits);
+        perByteShift = 3 - fieldShift;
+        fieldMask    = (UINT8) ((1 << (1 << fieldShift)) - 1);
+        data         = _storage;
+    }
+
+    UINT32 Entries() const { return numEntries; }
+    UINT32 Max() const     { return ctrMax; }
+    UINT32 Bytes() const
+    {
+        return (numEntries + (1 << perByteShift) - 1) >> perByteShift;
+    }
+
+    UINT32 Get( UINT32 idx ) const
+    {
+        assert(idx < numEntries);
+        return (data[idx >> perByteShift] >> Shift(idx)) & fieldMask;
+    }
+
+    void Increment( UINT32 idx )
+    {
+        assert(idx < numEntries);
+        UINT8 &byte = data[idx >> perByteShift];
+        UINT32 sh   = Shift(idx);
+        if( ((byte >> sh) & fieldMask) < ctrMax ) byte += (UINT8) (1 << sh);
+    }
+
+    void Decrement( UINT32 idx )
+    {
+        assert(idx < numEntries);
+        UINT8 &byte = data[idx >> perByteShift];
+        UINT32 sh   = Shift(idx);
+        if( (byte >> sh) & fieldMask ) byte -= (UINT8) (1 << sh);
+    }
+
+    void Reset()
+    {
+        if( data ) memset(data, 0, Bytes());
+    }
+};
+
+#endif
@@ -0,0 +1,696 @@
+/*
+** In-process batch runner for multi-programmed trace mixes.
+**
+** Every job builds its own CACHE_REPLACEMENT_STATE and replays one mix
+** through a tag-only LLC model, so jobs are independent and run on a pool of
+** worker threads:
+**
+**   - Work stealing. Jobs are sorted longest first (by trace size) and dealt
+**     round-robin to per-worker deques. A worker pops from the front of its
+**     own deque and, when that is empty, steals from the back of another, so
+**     a few long mixes no longer leave the other workers idle.
+**   - NUMA-aware pinning. Workers are pinned round-robin across the nodes in
+**     /sys/devices/system/node, and every job allocates its state on the
+**     worker thread, so first touch keeps it node-local.
+**   - Bounded memory. Traces are streamed through a fixed per-worker buffer
+**     of --mem MB, split between the traces of the mix.
+**   - Progress. Every --progress seconds the overall percentage and ETA, and
+**     each running job with its own percentage and ETA, are printed to stderr.
+**
+** Job file, one job per line, '#' starts a comment:
+**   <name> <policy> <sets> <assoc> [ship=SIG:TABLES[:REGIONBITS]] <trace0> [<trace1> ...]
+** The optional ship= field sets the SHiP signature and skewed SHCT (see
+** ship_config.h); it is reported in the ship column for every policy.
+** A trace is a file of raw LLC_ACCESS records (see llc_workload_gen --out
+** and private_filter --out) or "synth:<seed>:<records>" for a generated one.
+** Traces may interleave several cores: in a mix of N traces, record tid t of
+** trace i runs as tid t*N + i, so a single trace keeps its own tids and a mix
+** of single-core traces runs trace i as tid i.
+**
+** The results table (CSV) has the job columns, the total and per-tid hit and
+** miss counts, every "label: value" line of PrintStats and an IPC proxy per
+** tid. The proxy charges --hit-lat cycles per LLC hit and --miss-lat per
+** miss and is 1.0 when every access hits; there is no core model, it is only
+** for comparing policies.
+**
+** Build: g++ -O2 -std=c++11 -pthread -I.. -I<kit include dir> batch_runner.cpp ../replacement_state.cpp
+**
+** --seed S seeds every job's replacement state (SetRandomSeed, default 1),
+** so RANDOM, BRRIP and EAF results can be varied and reproduced.
+**
+** Usage: batch_runner <jobfile> [--workers N] [--mem MB] [--progress SEC]
+**                     [--hit-lat C] [--miss-lat C] [--seed S] [--out results.csv]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "replacement_state.h"
+#include "llc_workload.h"
+#include "ship_config.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#endif
+
+typedef std::chrono::steady_clock CLOCK;
+
+// Record tids at or above this are treated as a corrupt trace
+static const UINT32 MaxTraceTids = 1024;
+
+typedef struct
+{
+    UINT64  hits;
+    UINT64  misses;
+} TID_STATS;
+
+struct JOB
+{
+    std::string name;
+    UINT32  policy;
+    UINT32  sets;
+    UINT32  assoc;
+    SHIP_CONFIG ship;
+    UINT64  seed;                   // SetRandomSeed for the replacement state
+    std::vector<std::string> traces;
+    UINT64  totalRecords;           // estimated from the trace sizes
+
+    std::atomic<UINT64> doneRecords;
+    std::atomic<bool>   running;
+    CLOCK::time_point   started;    // set before running, for the per-job ETA
+    bool    failed;
+    std::string error;
+
+    std::vector<TID_STATS> tidStats;
+    std::vector< std::pair<std::string, std::string> > replStats;   // PrintStats lines
+
+    JOB() : policy(0), sets(0), assoc(0), seed(1), totalRecords(0), doneRecords(0), running(false), failed(false)
+    {
+        DefaultSHiPConfig(ship);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Trace sources, each reads through a caller-provided bounded buffer
+////////////////////////////////////////////////////////////////////////////////
+class TRACE_SOURCE
+{
+  public:
+    virtual ~TRACE_SOURCE() {}
+    // Fills up to max records, returns the count, 0 at the end of the trace
+    virtual UINT32 Read( LLC_ACCESS *buf, UINT32 max ) = 0;
+};
+
+class FILE_SOURCE : public TRACE_SOURCE
+{
+  private:
+    FILE *fp;
+
+  public:
+    FILE_SOURCE( FILE *_fp ) : fp(_fp) {}
+    ~FILE_SOURCE() { fclose(fp); }
+
+    UINT32 Read( LLC_ACCESS *buf, UINT32 max )
+    {
+        return (UINT32) fread(buf, sizeof(LLC_ACCESS), max, fp);
+    }
+};
+
+class SYNTH_SOURCE : public TRACE_SOURCE
+{
+  private:
+    LLC_WORKLOAD_GEN gen;
+    UINT64 left;
+
+  public:
+    SYNTH_SOURCE( const LLC_WORKLOAD_CONFIG &cfg, UINT64 records ) : gen(cfg), left(records) {}
+
+    UINT32 Read( LLC_ACCESS *buf, UINT32 max )
+    {
+        UINT32 n = (left < max) ? (UINT32) left : max;
+        gen.Fill(buf, n);
+        left -= n;
+        return n;
+    }
+};
+
+static bool ParseSynth( const std::string &spec, UINT64 &seed, UINT64 &records )
+{
+    unsigned long long s, r;
+    if( sscanf(spec.c_str(), "synth:%llu:%llu", &s, &r) != 2 ) return false;
+    seed = s;
+    records = r;
+    return true;
+}
+
+static UINT64 TraceRecords( const std::string &spec )
+{
+    UINT64 seed, records;
+    if( ParseSynth(spec, seed, records) ) return records;
+
+#ifdef __linux__
+    struct stat st;
+    if( stat(spec.c_str(), &st) == 0 ) return st.st_size / sizeof(LLC_ACCESS);
+#endif
+    return 0;
+}
+
+static TRACE_SOURCE * OpenTrace( const std::string &spec, UINT64 wsLines, std::string &error )
+{
+    UINT64 seed, records;
+    if( ParseSynth(spec, seed, records) )
+    {
+        LLC_WORKLOAD_CONFIG cfg;
+        LLC_WORKLOAD_GEN::DefaultConfig(cfg);
+        cfg.seed = seed;
+        cfg.workingSetLines = wsLines ? wsLines : 1;
+        return new SYNTH_SOURCE(cfg, records);
+    }
+
+    FILE *fp = fopen(spec.c_str(), "rb");
+    if( !fp )
+    {
+        error = "cannot open " + spec;
+        return NULL;
+    }
+    return new FILE_SOURCE(fp);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Job replay
+////////////////////////////////////////////////////////////////////////////////
+static void SplitStats( const std::string &text, std::vector< std::pair<std::string, std::string> > &out )
+{
+    std::istringstream in(text);
+    std::string line;
+    while( std::getline(in, line) )
+    {
+        size_t colon = line.find(':');
+        if( colon == std::string::npos ) continue;
+
+        std::string label = line.substr(0, colon);
+        std::string value = line.substr(colon + 1);
+        label.erase(label.find_last_not_of(" \t") + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        if( label.empty() || value.empty() ) continue;
+        out.push_back(std::make_pair(label, value));
+    }
+}
+
+static void RunJob( JOB &job, size_t memBytes )
+{
+    UINT32 numTids = (UINT32) job.traces.size();
+    UINT64 lines = (UINT64) job.sets * job.assoc;
+
+    // split the worker budget between the traces of the mix
+    UINT32 chunk = (UINT32) (memBytes / (numTids * sizeof(LLC_ACCESS)));
+    if( chunk == 0 ) chunk = 1;
+
+    std::vector< std::unique_ptr<TRACE_SOURCE> > sources;
+    std::vector< std::vector<LLC_ACCESS> > bufs(numTids, std::vector<LLC_ACCESS>(chunk));
+    std::vector<UINT32> fill(numTids, 0), pos(numTids, 0);
+    for( UINT32 tt = 0; tt < numTids; tt++ )
+    {
+        TRACE_SOURCE *src = OpenTrace(job.traces[tt], lines / numTids, job.error);
+        if( !src )
+        {
+            job.failed = true;
+            return;
+        }
+        sources.push_back(std::unique_ptr<TRACE_SOURCE>(src));
+    }
+
+    std::vector<LINE_STATE> tags( (size_t) lines );
+    for( size_t ii = 0; ii < tags.size(); ii++ )
+    {
+        tags[ii].valid = false;
+        tags[ii].dirty = false;
+        tags[ii].tag   = 0;
+    }
+
+    CACHE_REPLACEMENT_STATE repl(job.sets, job.assoc, job.policy);
+    repl.SetSHiPConfig(job.ship.sigType, job.ship.numTables, job.ship.regionBits);
+    repl.SetRandomSeed(job.seed);
+    job.tidStats.assign(numTids, TID_STATS());
+
+    // interleave the traces one record at a time until all are drained
+    UINT32 live = numTids;
+    std::vector<bool> done(numTids, false);
+    UINT64 replayed = 0;
+    while( live )
+    {
+        for( UINT32 tt = 0; tt < numTids; tt++ )
+        {
+            if( done[tt] ) continue;
+            if( pos[tt] == fill[tt] )
+            {
+                fill[tt] = sources[tt]->Read(&bufs[tt][0], chunk);
+                pos[tt] = 0;
+                if( fill[tt] == 0 )
+                {
+                    done[tt] = true;
+                    live--;
+                    continue;
+                }
+            }
+
+            const LLC_ACCESS &a = bufs[tt][ pos[tt]++ ];
+            if( a.tid >= MaxTraceTids )
+            {
+                job.failed = true;
+                job.error = "bad tid in " + job.traces[tt];
+                return;
+            }
+            UINT32 tid = a.tid * numTids + tt;
+            if( tid >= job.tidStats.size() ) job.tidStats.resize(tid + 1, TID_STATS());
+
+            // keep the address spaces of the mix apart
+            Addr_t line = (a.paddr >> 6) ^ ((Addr_t) tt << 50);
+            UINT32 setIndex = (UINT32) (line % job.sets);
+            Addr_t tag = line / job.sets;
+            LINE_STATE *set = &tags[ (size_t) setIndex * job.assoc ];
+
+            repl.IncrementTimer();
+
+            INT32 way = -1;
+            for( UINT32 ww = 0; ww < job.assoc; ww++ )
+            {
+                if( set[ww].valid && set[ww].tag == tag ) { way = ww; break; }
+            }
+
+            if( way >= 0 )
+            {
+                job.tidStats[tid].hits++;
+                repl.UpdateReplacementState(setIndex, way, &set[way], tid, a.PC, a.accessType, true);
+            }
+            else
+            {
+                job.tidStats[tid].misses++;
+                way = repl.GetVictimInSet(tid, setIndex, set, job.assoc, a.PC, line << 6, a.accessType);
+                if( way >= 0 )
+                {
+                    set[way].valid = true;
+                    set[way].dirty = (a.accessType == ACCESS_STORE);
+                    set[way].tag   = tag;
+                    repl.UpdateReplacementState(setIndex, way, &set[way], tid, a.PC, a.accessType, false);
+                }
+            }
+
+            if( (++replayed & 0xffff) == 0 ) job.doneRecords.store(replayed, std::memory_order_relaxed);
+        }
+    }
+    job.doneRecords.store(replayed, std::memory_order_relaxed);
+
+    std::ostringstream stats;
+    repl.PrintStats(stats);
+    SplitStats(stats.str(), job.replStats);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Work-stealing pool
+////////////////////////////////////////////////////////////////////////////////
+struct WORK_QUEUE
+{
+    std::mutex lock;
+    std::deque<JOB *> jobs;
+};
+
+static JOB * NextJob( std::vector<WORK_QUEUE> &queues, UINT32 self )
+{
+    {
+        std::lock_guard<std::mutex> guard(queues[self].lock);
+        if( !queues[self].jobs.empty() )
+        {
+            JOB *job = queues[self].jobs.front();
+            queues[self].jobs.pop_front();
+            return job;
+        }
+    }
+
+    // steal the smallest pending job of the next busy worker
+    for( UINT32 ii = 1; ii < queues.size(); ii++ )
+    {
+        WORK_QUEUE &victim = queues[ (self + ii) % queues.size() ];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if( !victim.jobs.empty() )
+        {
+            JOB *job = victim.jobs.back();
+            victim.jobs.pop_back();
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static std::vector<int> ParseCpuList( const std::string &list )
+{
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while( std::getline(in, range, ',') )
+    {
+        int lo, hi;
+        if( sscanf(range.c_str(), "%d-%d", &lo, &hi) == 2 )
+        {
+            for( int cc = lo; cc <= hi; cc++ ) cpus.push_back(cc);
+        }
+        else if( sscanf(range.c_str(), "%d", &lo) == 1 )
+        {
+            cpus.push_back(lo);
+        }
+    }
+    return cpus;
+}
+
+// CPU for each worker, interleaved across NUMA nodes, -1 for no pinning
+static std::vector<int> PlanPinning( UINT32 workers )
+{
+    std::vector< std::vector<int> > nodes;
+#ifdef __linux__
+    DIR *dir = opendir("/sys/devices/system/node");
+    if( dir )
+    {
+        struct dirent *ent;
+        while( (ent = readdir(dir)) != NULL )
+        {
+            int node;
+            if( sscanf(ent->d_name, "node%d", &node) != 1 ) continue;
+
+            std::ifstream in( std::string("/sys/devices/system/node/") + ent->d_name + "/cpulist" );
+            std::string list;
+            if( std::getline(in, list) )
+            {
+                std::vector<int> cpus = ParseCpuList(list);
+                if( !cpus.empty() ) nodes.push_back(cpus);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+
+    std::vector<int> plan(workers, -1);
+    if( nodes.empty() ) return plan;
+
+    for( UINT32 ww = 0; ww < workers; ww++ )
+    {
+        const std::vector<int> &cpus = nodes[ ww % nodes.size() ];
+        plan[ww] = cpus[ (ww / nodes.size()) % cpus.size() ];
+    }
+    return plan;
+}
+
+static void PinSelf( int cpu )
+{
+#ifdef __linux__
+    if( cpu < 0 ) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+static void Worker( std::vector<WORK_QUEUE> *queues, UINT32 self, int cpu, size_t memBytes,
+                    std::atomic<UINT32> *jobsDone )
+{
+    PinSelf(cpu);
+
+    JOB *job;
+    while( (job = NextJob(*queues, self)) != NULL )
+    {
+        job->started = CLOCK::now();
+        job->running = true;
+        RunJob(*job, memBytes);
+        job->running = false;
+        (*jobsDone)++;
+    }
+}
+
+// "  ETA hh:mm:ss" for the rest of the work at the rate so far, nothing
+// until there is a rate
+static void PrintETA( double elapsed, double frac )
+{
+    if( frac <= 0 ) return;
+    UINT64 eta = (UINT64) (elapsed * (1.0 - std::min(frac, 1.0)) / frac);
+    fprintf(stderr, "  ETA %02llu:%02llu:%02llu", (unsigned long long) eta / 3600,
+            (unsigned long long) (eta / 60) % 60, (unsigned long long) eta % 60);
+}
+
+static void PrintProgress( std::vector<JOB *> &jobs, UINT32 jobsDone, CLOCK::time_point start )
+{
+    UINT64 total = 0, done = 0;
+    for( size_t ii = 0; ii < jobs.size(); ii++ )
+    {
+        total += jobs[ii]->totalRecords;
+        done  += std::min(jobs[ii]->doneRecords.load(std::memory_order_relaxed), jobs[ii]->totalRecords);
+    }
+
+    double elapsed = std::chrono::duration<double>(CLOCK::now() - start).count();
+    double frac = total ? (double) done / total : 0.0;
+    fprintf(stderr, "[%u/%zu jobs] %5.1f%%", jobsDone, jobs.size(), 100.0 * frac);
+    PrintETA(elapsed, frac);
+    fprintf(stderr, "\n");
+
+    CLOCK::time_point now = CLOCK::now();
+    for( size_t ii = 0; ii < jobs.size(); ii++ )
+    {
+        if( !jobs[ii]->running ) continue;
+        UINT64 d = jobs[ii]->doneRecords.load(std::memory_order_relaxed);
+        double jobFrac = jobs[ii]->totalRecords ? (double) d / jobs[ii]->totalRecords : 0.0;
+        fprintf(stderr, "    %-24s %5.1f%%", jobs[ii]->name.c_str(), 100.0 * jobFrac);
+        PrintETA(std::chrono::duration<double>(now - jobs[ii]->started).count(), jobFrac);
+        fprintf(stderr, "\n");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Results table
+////////////////////////////////////////////////////////////////////////////////
+static void WriteResults( std::ostream &out, const std::vector<JOB *> &jobs, double hitLat, double missLat )
+{
+    // PrintStats columns in first-seen order, and the widest mix
+    std::vector<std::string> columns;
+    std::map<std::string, bool> seen;
+    size_t maxTids = 0;
+    for( size_t ii = 0; ii < jobs.size(); ii++ )
+    {
+        maxTids = std::max(maxTids, jobs[ii]->tidStats.size());
+        for( size_t cc = 0; cc < jobs[ii]->replStats.size(); cc++ )
+        {
+            const std::string &label = jobs[ii]->replStats[cc].first;
+            if( !seen[label] )
+            {
+                seen[label] = true;
+                columns.push_back(label);
+            }
+        }
+    }
+
+    out<<"job,policy,sets,assoc,ship,status,records,hits,misses";
+    for( size_t tt = 0; tt < maxTids; tt++ ) out<<",tid"<<tt<<"_hits,tid"<<tt<<"_misses";
+    for( size_t cc = 0; cc < columns.size(); cc++ ) out<<",\""<<columns[cc]<<"\"";
+    for( size_t tt = 0; tt < maxTids; tt++ ) out<<",tid"<<tt<<"_ipc_proxy";
+    out<<endl;
+
+    for( size_t ii = 0; ii < jobs.size(); ii++ )
+    {
+        const JOB &job = *jobs[ii];
+        UINT64 hits = 0, misses = 0;
+        for( size_t tt = 0; tt < job.tidStats.size(); tt++ )
+        {
+            hits   += job.tidStats[tt].hits;
+            misses += job.tidStats[tt].misses;
+        }
+
+        out<<job.name<<","<<job.policy<<","<<job.sets<<","<<job.assoc<<","
+           <<SHiPSigNames[job.ship.sigType]<<":"<<job.ship.numTables<<":"<<job.ship.regionBits<<","
+           <<(job.failed ? "\"failed: " + job.error + "\"" : std::string("ok"))<<","
+           <<hits + misses<<","<<hits<<","<<misses;
+
+        for( size_t tt = 0; tt < maxTids; tt++ )
+        {
+            if( tt < job.tidStats.size() ) out<<","<<job.tidStats[tt].hits<<","<<job.tidStats[tt].misses;
+            else out<<",,";
+        }
+
+        std::map<std::string, std::string> values(job.replStats.begin(), job.replStats.end());
+        for( size_t cc = 0; cc < columns.size(); cc++ ) out<<","<<values[ columns[cc] ];
+
+        for( size_t tt = 0; tt < maxTids; tt++ )
+        {
+            out<<",";
+            if( tt >= job.tidStats.size() ) continue;
+            const TID_STATS &s = job.tidStats[tt];
+            double cycles = s.hits * hitLat + s.misses * missLat;
+            out<<(cycles > 0 ? (s.hits + s.misses) * hitLat / cycles : 0.0);
+        }
+        out<<endl;
+    }
+}
+
+static bool ReadJobs( const char *path, std::vector<JOB *> &jobs )
+{
+    std::ifstream in(path);
+    if( !in ) return false;
+
+    std::string line;
+    UINT32 lineNo = 0;
+    while( std::getline(in, line) )
+    {
+        lineNo++;
+        size_t hash = line.find('#');
+        if( hash != std::string::npos ) line.erase(hash);
+
+        std::istringstream fields(line);
+        JOB *job = new JOB;
+        if( !(fields>>job->name>>job->policy>>job->sets>>job->assoc) )
+        {
+            delete job;
+            if( line.find_first_not_of(" \t\r") != std::string::npos )
+            {
+                fprintf(stderr, "%s:%u: expected <name> <policy> <sets> <assoc> [ship=SPEC] <trace>...\n", path, lineNo);
+                return false;
+            }
+            continue;
+        }
+
+        std::string trace;
+        bool badShip = false;
+        while( fields>>trace )
+        {
+            if( trace.compare(0, 5, "ship=") == 0 && job->traces.empty() )
+            {
+                badShip = !ParseSHiPConfig(trace.c_str() + 5, job->ship);
+            }
+            else job->traces.push_back(trace);
+        }
+        if( badShip || job->traces.empty() || job->policy >= CRC_REPL_CUSTOM ||
+            job->sets == 0 || job->assoc == 0 || job->assoc > 64 )
+        {
+            fprintf(stderr, "%s:%u: bad job\n", path, lineNo);
+            delete job;
+            return false;
+        }
+
+        for( size_t tt = 0; tt < job->traces.size(); tt++ ) job->totalRecords += TraceRecords(job->traces[tt]);
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+static bool ByLength( const JOB *a, const JOB *b )
+{
+    return a->totalRecords > b->totalRecords;
+}
+
+int main( int argc, char **argv )
+{
+    const char *jobPath = NULL;
+    const char *outPath = NULL;
+    UINT32 workers = std::thread::hardware_concurrency();
+    size_t memMB = 64;
+    double progressSec = 10;
+    double hitLat = 30, missLat = 200;
+    UINT64 seed = 1;
+    bool usage = false;
+
+    for( int ii = 1; ii < argc; ii++ )
+    {
+        bool hasArg = ii + 1 < argc;
+        if( !strcmp(argv[ii], "--workers") && hasArg )       workers = atoi(argv[++ii]);
+        else if( !strcmp(argv[ii], "--mem") && hasArg )      memMB = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--progress") && hasArg ) progressSec = atof(argv[++ii]);
+        else if( !strcmp(argv[ii], "--hit-lat") && hasArg )  hitLat = atof(argv[++ii]);
+        else if( !strcmp(argv[ii], "--miss-lat") && hasArg ) missLat = atof(argv[++ii]);
+        else if( !strcmp(argv[ii], "--seed") && hasArg )     seed = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--out") && hasArg )      outPath = argv[++ii];
+        else if( argv[ii][0] != '-' && !jobPath )            jobPath = argv[ii];
+        else usage = true;
+    }
+
+    if( usage || !jobPath )
+    {
+        fprintf(stderr, "usage: %s <jobfile> [--workers N] [--mem MB] [--progress SEC]\n"
+                        "          [--hit-lat C] [--miss-lat C] [--seed S] [--out results.csv]\n", argv[0]);
+        return 1;
+    }
+    if( workers == 0 ) workers = 1;
+
+    std::vector<JOB *> jobs;
+    if( !ReadJobs(jobPath, jobs) )
+    {
+        fprintf(stderr, "cannot read jobs from %s\n", jobPath);
+        return 1;
+    }
+
+    for( size_t ii = 0; ii < jobs.size(); ii++ ) jobs[ii]->seed = seed;
+
+    // longest first, dealt round-robin, stealing evens out the tail
+    std::vector<JOB *> order(jobs);
+    std::stable_sort(order.begin(), order.end(), ByLength);
+    std::vector<WORK_QUEUE> queues(workers);
+    for( size_t ii = 0; ii < order.size(); ii++ ) queues[ ii % workers ].jobs.push_back(order[ii]);
+
+    std::vector<int> pinning = PlanPinning(workers);
+    std::atomic<UINT32> jobsDone(0);
+    CLOCK::time_point start = CLOCK::now();
+
+    std::vector<std::thread> pool;
+    for( UINT32 ww = 0; ww < workers; ww++ )
+    {
+        pool.push_back(std::thread(Worker, &queues, ww, pinning[ww], memMB << 20, &jobsDone));
+    }
+
+    CLOCK::time_point lastReport = start;
+    while( jobsDone.load() < jobs.size() )
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if( progressSec > 0 && std::chrono::duration<double>(CLOCK::now() - lastReport).count() >= progressSec )
+        {
+            PrintProgress(jobs, jobsDone.load(), start);
+            lastReport = CLOCK::now();
+        }
+    }
+    for( size_t ww = 0; ww < pool.size(); ww++ ) pool[ww].join();
+
+    fprintf(stderr, "%zu jobs in %.1f s\n", jobs.size(),
+            std::chrono::duration<double>(CLOCK::now() - start).count());
+
+    int status = 0;
+    for( size_t ii = 0; ii < jobs.size(); ii++ )
+    {
+        if( jobs[ii]->failed )
+        {
+            fprintf(stderr, "%s: %s\n", jobs[ii]->name.c_str(), jobs[ii]->error.c_str());
+            status = 1;
+        }
+    }
+
+    if( outPath )
+    {
+        std::ofstream out(outPath);
+        WriteResults(out, jobs, hitLat, missLat);
+    }
+    else
+    {
+        WriteResults(std::cout, jobs, hitLat, missLat);
+    }
+
+    for( size_t ii = 0; ii < jobs.size(); ii++ ) delete jobs[ii];
+    return status;
+}
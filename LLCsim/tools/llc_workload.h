@@ -0,0 +1,334 @@
+#ifndef LLC_WORKLOAD_H
+#define LLC_WORKLOAD_H
+
+/*
+** Seeded synthetic LLC access generator. Each call to Next() produces one
+** (tid, PC, paddr, accessType) record, Fill() produces the same records in
+** batches; nothing is buffered beyond the small per-thread state, so streams
+** of any length cost no disk and the same seed and config always reproduce
+** the same stream.
+**
+** Patterns, mixed by weight. A pattern is drawn for a burst of burstLength
+** records rather than per record. Fill() dispatches once per burst and runs
+** the rest of it in a loop specialized for the pattern. Measured on one
+** core of the development host, that gives about 105-125M records/s with
+** the default 16-record bursts. Bursts of 1 give a true per-access mix at
+** about 40M records/s, because every record then pays a mispredicted
+** pattern branch. For more than that, run several generators in parallel.
+**
+**   SCAN    sequential lines that are never touched again, what BRRIP/DRRIP
+**           should keep from flushing the cache
+**   THRASH  a cyclic walk over thrashFactor x the working set, so LRU misses
+**           on every access once the working set is the cache size
+**   PCREUSE a few hot PCs reuse a working-set-sized region while many cold
+**           PCs stream, so the PC predicts reuse (SHiP)
+**   EVICTED re-references the line from evictDistance accesses ago, just
+**           after LRU would have evicted it (EAF)
+**   RANDOM  uniform reuse over the working set
+**
+** Threads are interleaved round-robin and get disjoint address spaces.
+*/
+
+#include <cassert>
+#include <cstring>
+#include "utils.h"
+#include "crc_cache_defs.h"
+
+typedef enum
+{
+    WL_SCAN     = 0,
+    WL_THRASH   = 1,
+    WL_PCREUSE  = 2,
+    WL_EVICTED  = 3,
+    WL_RANDOM   = 4,
+    WL_NUM_PATTERNS
+} WorkloadPattern;
+
+// Also the on-disk trace record (llc_workload_gen --out, private_filter,
+// batch_runner): 24 bytes in host byte order, fields ordered so the struct
+// has no padding and every byte written is defined.
+typedef struct
+{
+    Addr_t  PC;
+    Addr_t  paddr;
+    UINT32  tid;
+    UINT32  accessType;
+} LLC_ACCESS;
+
+static_assert(sizeof(LLC_ACCESS) == 24, "LLC_ACCESS is the on-disk trace record and must not have padding");
+
+typedef struct
+{
+    UINT64  seed;
+    UINT32  numThreads;
+    UINT64  workingSetLines;    // typically the LLC size in lines
+    double  thrashFactor;       // THRASH cycle length / working set
+    double  evictFactor;        // EVICTED reuse distance / working set
+    UINT32  storeRatio;         // 1 in storeRatio accesses is a store, 0 for none
+    UINT32  burstLength;        // records per pattern draw
+    UINT32  weight[WL_NUM_PATTERNS];
+} LLC_WORKLOAD_CONFIG;
+
+class LLC_WORKLOAD_GEN
+{
+  private:
+    typedef struct
+    {
+        Addr_t  base;           // start of this thread's address space
+        UINT64  scanPos;
+        UINT64  thrashPos;
+        UINT64  freshPos;       // fresh lines for PCREUSE and EVICTED
+        Addr_t *history;        // last evictDistance lines of this thread
+        UINT64  historyPos;
+    } THREAD_STATE;
+
+    LLC_WORKLOAD_CONFIG cfg;
+    THREAD_STATE *threads;
+    UINT32 nextTid;
+    UINT32 pattern;             // pattern of the current burst
+    UINT32 burstLeft;
+    UINT64 rng;
+    UINT64 thrashLines;
+    UINT64 evictDistance;
+    UINT32 storeThresh;         // 16 random bits below this make a store
+    UINT8  patternTable[256];   // random byte -> pattern, by weight
+
+    LLC_WORKLOAD_GEN( const LLC_WORKLOAD_GEN & );
+    LLC_WORKLOAD_GEN & operator=( const LLC_WORKLOAD_GEN & );
+
+    // Uniform in [0, n) from 32 random bits, without a divide
+    static UINT64 Scale( UINT64 r, UINT64 n )
+    {
+        return ((r & 0xffffffffULL) * n) >> 32;
+    }
+
+    // xorshift64*
+    static UINT64 Step( UINT64 &x )
+    {
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        return x * 0x2545F4914F6CDD1DULL;
+    }
+
+    UINT64 Rand() { return Step(rng); }
+
+    // Region layout inside a thread's space, in lines
+    static const UINT64 ScanRegion   = 1ULL << 36;
+    static const UINT64 ThrashRegion = 2ULL << 36;
+    static const UINT64 ReuseRegion  = 3ULL << 36;
+    static const UINT64 FreshRegion  = 4ULL << 36;
+    static const UINT32 HotPCs       = 16;
+    static const UINT32 ColdPCs      = 240;
+
+    // One record of pattern P for thread tid (state ts) from the random bits r
+    template <UINT32 P>
+    void Generate( LLC_ACCESS &a, UINT64 r, UINT32 tid, THREAD_STATE &ts )
+    {
+
+        UINT64 line;
+        Addr_t PC;
+        UINT32 pcBits  = (UINT32) (r >> 8) & 0xff;
+
+        switch( P )
+        {
+          case WL_SCAN:
+            line = ScanRegion + ts.scanPos++;
+            PC   = 0x401000 + (pcBits & 3) * 4;
+            break;
+
+          case WL_THRASH:
+            line = ThrashRegion + ts.thrashPos;
+            if( ++ts.thrashPos == thrashLines ) ts.thrashPos = 0;
+            PC   = 0x402000 + (pcBits & 3) * 4;
+            break;
+
+          case WL_PCREUSE:
+            if( pcBits < HotPCs )
+            {
+                line = ReuseRegion + Scale(r >> 16, cfg.workingSetLines);
+                PC   = 0x403000 + pcBits * 4;
+            }
+            else
+            {
+                line = FreshRegion + ts.freshPos++;
+                PC   = 0x404000 + (pcBits % ColdPCs) * 4;
+            }
+            break;
+
+          case WL_EVICTED:
+            // the oldest history slot is the line this thread touched
+            // evictDistance accesses ago, empty until the ring has wrapped
+            line = ts.history[ ts.historyPos ];
+            if( !line ) line = FreshRegion + ts.freshPos++;
+            PC   = 0x405000 + (pcBits & 7) * 4;
+            break;
+
+          default:
+            line = ReuseRegion + Scale(r >> 16, cfg.workingSetLines);
+            PC   = 0x406000 + (pcBits & 15) * 4;
+            break;
+        }
+
+        ts.history[ ts.historyPos ] = line;
+        if( ++ts.historyPos == evictDistance ) ts.historyPos = 0;
+
+        a.tid        = tid;
+        a.PC         = PC;
+        a.paddr      = ts.base + (line << 6);
+        a.accessType = (((r >> 48) & 0xffff) < storeThresh) ? ACCESS_STORE : ACCESS_LOAD;
+    }
+
+    // The record stores may alias any UINT64 member, which would force the
+    // generator and thread cursors through memory on every record. So the
+    // random bits are drawn first, in record order, and parked in paddr; then
+    // each thread's records (every numThreads-th one) are generated from a
+    // local copy of its state that stays in registers.
+    template <UINT32 P>
+    void FillRun( LLC_ACCESS *out, UINT32 run )
+    {
+        UINT64 x = rng;
+        for( UINT32 ii = 0; ii < run; ii++ ) out[ii].paddr = Step(x);
+        rng = x;
+
+        const UINT32 numThreads = cfg.numThreads;
+        for( UINT32 tt = 0; tt < numThreads && tt < run; tt++ )
+        {
+            UINT32 tid = nextTid + tt;
+            if( tid >= numThreads ) tid -= numThreads;
+
+            THREAD_STATE ts = threads[tid];
+            for( UINT32 ii = tt; ii < run; ii += numThreads ) Generate<P>(out[ii], out[ii].paddr, tid, ts);
+            threads[tid] = ts;
+        }
+        nextTid = (UINT32) ((nextTid + run) % numThreads);
+    }
+
+  public:
+    LLC_WORKLOAD_GEN( const LLC_WORKLOAD_CONFIG &_cfg ) : cfg(_cfg), threads(NULL)
+    {
+        assert(cfg.numThreads > 0);
+        assert(cfg.workingSetLines > 0);
+        assert(cfg.burstLength > 0);
+
+        thrashLines   = (UINT64) (cfg.workingSetLines * cfg.thrashFactor);
+        evictDistance = (UINT64) (cfg.workingSetLines * cfg.evictFactor);
+        if( thrashLines == 0 ) thrashLines = 1;
+        if( evictDistance == 0 ) evictDistance = 1;
+
+        storeThresh = cfg.storeRatio ? 65536 / cfg.storeRatio : 0;
+
+        UINT32 totalWeight = 0;
+        for( UINT32 pp = 0; pp < WL_NUM_PATTERNS; pp++ ) totalWeight += cfg.weight[pp];
+        assert(totalWeight > 0);
+
+        // spread the 256 table slots in proportion to the weights
+        UINT32 slot = 0, running = 0;
+        for( UINT32 pp = 0; pp < WL_NUM_PATTERNS; pp++ )
+        {
+            running += cfg.weight[pp];
+            UINT32 end = (running * 256) / totalWeight;
+            for( ; slot < end; slot++ ) patternTable[slot] = (UINT8) pp;
+        }
+
+        threads = new THREAD_STATE[ cfg.numThreads ];
+        for( UINT32 tt = 0; tt < cfg.numThreads; tt++ )
+        {
+            threads[tt].base       = (Addr_t) tt << 48;
+            threads[tt].scanPos    = 0;
+            threads[tt].thrashPos  = 0;
+            threads[tt].freshPos   = 0;
+            threads[tt].history    = new Addr_t[ evictDistance ];
+        }
+
+        Reset();
+    }
+
+    ~LLC_WORKLOAD_GEN()
+    {
+        for( UINT32 tt = 0; tt < cfg.numThreads; tt++ ) delete [] threads[tt].history;
+        delete [] threads;
+    }
+
+    // Restart the stream from the beginning
+    void Reset()
+    {
+        rng = cfg.seed ? cfg.seed : 0x9E3779B97F4A7C15ULL;
+        nextTid = 0;
+        burstLeft = 1;
+        for( UINT32 tt = 0; tt < cfg.numThreads; tt++ )
+        {
+            threads[tt].scanPos    = 0;
+            threads[tt].thrashPos  = 0;
+            threads[tt].freshPos   = 0;
+            threads[tt].historyPos = 0;
+            memset(threads[tt].history, 0, evictDistance * sizeof(Addr_t));
+        }
+    }
+
+    void Next( LLC_ACCESS &a )
+    {
+        UINT64 r = Rand();
+        if( --burstLeft == 0 )
+        {
+            pattern = patternTable[ r & 0xff ];
+            burstLeft = cfg.burstLength;
+        }
+
+        UINT32 tid = nextTid;
+        if( ++nextTid == cfg.numThreads ) nextTid = 0;
+        THREAD_STATE &ts = threads[tid];
+
+        switch( pattern )
+        {
+          case WL_SCAN:     Generate<WL_SCAN>(a, r, tid, ts); break;
+          case WL_THRASH:   Generate<WL_THRASH>(a, r, tid, ts); break;
+          case WL_PCREUSE:  Generate<WL_PCREUSE>(a, r, tid, ts); break;
+          case WL_EVICTED:  Generate<WL_EVICTED>(a, r, tid, ts); break;
+          default:          Generate<WL_RANDOM>(a, r, tid, ts); break;
+        }
+    }
+
+    // Same records as n calls to Next, but the pattern is dispatched once
+    // per burst and the rest of the burst runs in a loop specialized for it
+    void Fill( LLC_ACCESS *out, UINT64 n )
+    {
+        while( n )
+        {
+            // the first record of a burst draws the pattern
+            if( burstLeft == 1 )
+            {
+                Next(*out++);
+                n--;
+                continue;
+            }
+
+            UINT32 run = (n < burstLeft - 1) ? (UINT32) n : burstLeft - 1;
+            switch( pattern )
+            {
+              case WL_SCAN:     FillRun<WL_SCAN>(out, run); break;
+              case WL_THRASH:   FillRun<WL_THRASH>(out, run); break;
+              case WL_PCREUSE:  FillRun<WL_PCREUSE>(out, run); break;
+              case WL_EVICTED:  FillRun<WL_EVICTED>(out, run); break;
+              default:          FillRun<WL_RANDOM>(out, run); break;
+            }
+            burstLeft -= run;
+            out += run;
+            n -= run;
+        }
+    }
+
+    static void DefaultConfig( LLC_WORKLOAD_CONFIG &c )
+    {
+        c.seed            = 1;
+        c.numThreads      = 1;
+        c.workingSetLines = 16 * 1024;      // 1MB LLC of 64B lines
+        c.thrashFactor    = 1.25;
+        c.evictFactor     = 1.25;
+        c.storeRatio      = 8;
+        c.burstLength     = 16;
+        for( UINT32 pp = 0; pp < WL_NUM_PATTERNS; pp++ ) c.weight[pp] = 1;
+    }
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+** Command line front end for LLC_WORKLOAD_GEN.
+**
+** Without --out or --text the records are only consumed and the generation
+** rate is printed, which is the number to check before blaming the generator
+** for a slow benchmark. --out writes 24-byte LLC_ACCESS trace records (see
+** llc_workload.h), --text prints "tid PC paddr accessType" lines. A stream is fully described by its
+** options, so storing the command line is enough to reproduce it.
+**
+** Build: g++ -O2 -std=c++11 -I.. -I<kit include dir> llc_workload_gen.cpp
+**
+** Usage: llc_workload_gen [--records N] [--seed S] [--threads T] [--ws LINES]
+**                         [--mix scan,thrash,pcreuse,evicted,random]
+**                         [--thrash F] [--evict F] [--stores R] [--burst B]
+**                         [--out FILE | --text]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "llc_workload.h"
+
+static void Usage( const char *prog )
+{
+    fprintf(stderr, "usage: %s [--records N] [--seed S] [--threads T] [--ws LINES]\n"
+                    "          [--mix scan,thrash,pcreuse,evicted,random] [--thrash F] [--evict F]\n"
+                    "          [--stores R] [--burst B] [--out FILE | --text]\n", prog);
+    exit(1);
+}
+
+int main( int argc, char **argv )
+{
+    LLC_WORKLOAD_CONFIG cfg;
+    LLC_WORKLOAD_GEN::DefaultConfig(cfg);
+
+    UINT64 records = 100 * 1000 * 1000;
+    const char *outPath = NULL;
+    bool text = false;
+
+    for( int ii = 1; ii < argc; ii++ )
+    {
+        bool hasArg = ii + 1 < argc;
+        if( !strcmp(argv[ii], "--records") && hasArg )      records = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--seed") && hasArg )    cfg.seed = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--threads") && hasArg ) cfg.numThreads = atoi(argv[++ii]);
+        else if( !strcmp(argv[ii], "--ws") && hasArg )      cfg.workingSetLines = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--thrash") && hasArg )  cfg.thrashFactor = atof(argv[++ii]);
+        else if( !strcmp(argv[ii], "--evict") && hasArg )   cfg.evictFactor = atof(argv[++ii]);
+        else if( !strcmp(argv[ii], "--stores") && hasArg )  cfg.storeRatio = atoi(argv[++ii]);
+        else if( !strcmp(argv[ii], "--burst") && hasArg )   cfg.burstLength = atoi(argv[++ii]);
+        else if( !strcmp(argv[ii], "--out") && hasArg )     outPath = argv[++ii];
+        else if( !strcmp(argv[ii], "--text") )              text = true;
+        else if( !strcmp(argv[ii], "--mix") && hasArg )
+        {
+            UINT32 *w = cfg.weight;
+            if( sscanf(argv[++ii], "%u,%u,%u,%u,%u", &w[0], &w[1], &w[2], &w[3], &w[4]) != WL_NUM_PATTERNS )
+            {
+                Usage(argv[0]);
+            }
+        }
+        else Usage(argv[0]);
+    }
+
+    if( cfg.numThreads == 0 || cfg.workingSetLines == 0 || cfg.burstLength == 0 ) Usage(argv[0]);
+
+    LLC_WORKLOAD_GEN gen(cfg);
+    LLC_ACCESS a;
+
+    if( text )
+    {
+        for( UINT64 ii = 0; ii < records; ii++ )
+        {
+            gen.Next(a);
+            printf("%u 0x%llx 0x%llx %u\n", a.tid, (unsigned long long) a.PC,
+                   (unsigned long long) a.paddr, a.accessType);
+        }
+        return 0;
+    }
+
+    if( outPath )
+    {
+        FILE *out = fopen(outPath, "wb");
+        if( !out )
+        {
+            perror(outPath);
+            return 1;
+        }
+
+        const UINT32 chunk = 64 * 1024;
+        LLC_ACCESS *buf = new LLC_ACCESS[ chunk ];
+        for( UINT64 done = 0; done < records; )
+        {
+            UINT32 n = (records - done < chunk) ? (UINT32) (records - done) : chunk;
+            gen.Fill(buf, n);
+            fwrite(buf, sizeof(LLC_ACCESS), n, out);
+            done += n;
+        }
+        delete [] buf;
+        fclose(out);
+        return 0;
+    }
+
+    // throughput only, through a buffer that stays in L1/L2 like a consumer's
+    // would; the checksum keeps the loop from being optimized out
+    const UINT32 chunk = 1024;
+    LLC_ACCESS buf[ chunk ];
+    UINT64 checksum = 0;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for( UINT64 done = 0; done < records; )
+    {
+        UINT32 n = (records - done < chunk) ? (UINT32) (records - done) : chunk;
+        gen.Fill(buf, n);
+        for( UINT32 jj = 0; jj < n; jj++ ) checksum += buf[jj].paddr ^ buf[jj].PC;
+        done += n;
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    printf("%llu records in %.3f s, %.1f M records/s (checksum %llx)\n",
+           (unsigned long long) records, secs, records / secs / 1e6, (unsigned long long) checksum);
+    return 0;
+}
@@ -0,0 +1,302 @@
+#ifndef PRIVATE_CACHE_FILTER_H
+#define PRIVATE_CACHE_FILTER_H
+
+/*
+** Private L1/L2 filter that turns raw per-core memory streams into the LLC
+** access stream CACHE_REPLACEMENT_STATE sees. Every tid gets its own L1 and
+** L2, created on first use.
+**
+** For each input record the filter emits zero or more LLC records: the
+** demand miss (keeping the original accessType and PC) and any dirty lines
+** leaving the L2, as ACCESS_WRITEBACK with PC 0. Misses allocate in L1 and L2
+** in both modes; they differ in what an L2 eviction does:
+**   inclusive      the line is back-invalidated from L1, a dirty L1 copy
+**                  makes the writeback dirty
+**   non-inclusive  L1 keeps its copy, a later dirty L1 eviction that misses
+**                  the L2 goes straight to the LLC as a writeback
+**
+** Both levels use LRU or tree PLRU (associativity must then be a power of 2).
+** Set counts must be powers of 2 so indexing is a mask, not a divide.
+*/
+
+#include <cassert>
+#include <vector>
+#include "utils.h"
+#include "crc_cache_defs.h"
+#include "llc_workload.h"
+
+typedef enum
+{
+    PRIV_REPL_LRU   = 0,
+    PRIV_REPL_PLRU  = 1
+} PrivateReplPolicy;
+
+typedef struct
+{
+    UINT32  l1Sets, l1Assoc;
+    UINT32  l2Sets, l2Assoc;
+    UINT32  replPolicy;
+    bool    inclusive;
+} PRIVATE_FILTER_CONFIG;
+
+class PRIVATE_CACHE
+{
+  private:
+    // Structure of arrays so a set scan touches only the tags. A tag of 0 is
+    // an invalid way (lines are stored +1), and invalid ways keep LRU stamp 0
+    // so the LRU victim search picks them first without a separate pass.
+    UINT32 numsets;
+    UINT32 setMask;
+    UINT32 assoc;
+    UINT32 replPolicy;
+    UINT64 clock;
+    std::vector<Addr_t> tags;
+    std::vector<UINT64> lastUse;    // LRU stamps
+    std::vector<UINT8>  dirty;
+    std::vector<UINT64> plru;       // assoc-1 tree bits per set, 1 = go right
+
+    // victim chosen by the last Lookup that missed
+    Addr_t missLine;
+    UINT32 missWay;
+
+    size_t Base( Addr_t line ) const { return (size_t) (line & setMask) * assoc; }
+
+    void Touch( Addr_t line, size_t base, UINT32 way )
+    {
+        if( replPolicy == PRIV_REPL_LRU )
+        {
+            lastUse[ base + way ] = ++clock;
+            return;
+        }
+
+        // point every node on the path away from way
+        UINT64 &bits = plru[ line & setMask ];
+        UINT32 node = 0;
+        for( UINT32 span = assoc >> 1; span; span >>= 1 )
+        {
+            bool right = (way & span) != 0;
+            if( right ) bits &= ~(1ULL << node);
+            else bits |= (1ULL << node);
+            node = 2 * node + 1 + (right ? 1 : 0);
+        }
+    }
+
+    UINT32 PLRUVictim( Addr_t line, size_t base ) const
+    {
+        for( UINT32 way = 0; way < assoc; way++ )
+        {
+            if( !tags[ base + way ] ) return way;
+        }
+
+        UINT64 bits = plru[ line & setMask ];
+        UINT32 node = 0, way = 0;
+        for( UINT32 span = assoc >> 1; span; span >>= 1 )
+        {
+            bool right = (bits >> node) & 1;
+            if( right ) way |= span;
+            node = 2 * node + 1 + (right ? 1 : 0);
+        }
+        return way;
+    }
+
+    INT32 Find( Addr_t line, size_t base ) const
+    {
+        for( UINT32 way = 0; way < assoc; way++ )
+        {
+            if( tags[ base + way ] == line + 1 ) return way;
+        }
+        return -1;
+    }
+
+  public:
+    PRIVATE_CACHE( UINT32 _sets, UINT32 _assoc, UINT32 _policy )
+        : numsets(_sets), setMask(_sets - 1), assoc(_assoc), replPolicy(_policy), clock(0),
+          missLine(0), missWay(0)
+    {
+        assert(numsets > 0 && (numsets & (numsets - 1)) == 0 && assoc > 0);
+        assert(replPolicy != PRIV_REPL_PLRU || ((assoc & (assoc - 1)) == 0 && assoc <= 64));
+
+        tags.assign( (size_t) numsets * assoc, 0 );
+        lastUse.assign( (size_t) numsets * assoc, 0 );
+        dirty.assign( (size_t) numsets * assoc, 0 );
+        plru.assign( numsets, 0 );
+    }
+
+    // Looks the line up, on a hit updates recency and the dirty bit. On a
+    // miss the victim is found in the same pass and kept for Fill.
+    bool Lookup( Addr_t line, bool write )
+    {
+        size_t base = Base(line);
+        UINT32 victim = 0;
+        for( UINT32 way = 0; way < assoc; way++ )
+        {
+            if( tags[ base + way ] == line + 1 )
+            {
+                if( write ) dirty[ base + way ] = 1;
+                Touch(line, base, way);
+                return true;
+            }
+            if( lastUse[ base + way ] < lastUse[ base + victim ] ) victim = way;
+        }
+
+        missLine = line;
+        missWay  = (replPolicy == PRIV_REPL_LRU) ? victim : PLRUVictim(line, base);
+        return false;
+    }
+
+    // Allocates a line that just missed Lookup, returns true if a valid line
+    // was evicted
+    bool Fill( Addr_t line, bool isDirty, Addr_t &victimLine, bool &victimDirty )
+    {
+        assert(line == missLine);
+        size_t base = Base(line);
+        size_t slot = base + missWay;
+        bool evicted = tags[ slot ] != 0;
+
+        victimLine  = tags[ slot ] - 1;
+        victimDirty = dirty[ slot ] != 0;
+
+        tags[ slot ]  = line + 1;
+        dirty[ slot ] = isDirty;
+        Touch(line, base, missWay);
+        return evicted;
+    }
+
+    // Removes the line if present, returns true if the removed copy was dirty
+    bool Invalidate( Addr_t line )
+    {
+        size_t base = Base(line);
+        INT32 way = Find(line, base);
+        if( way < 0 ) return false;
+
+        tags[ base + way ]    = 0;
+        lastUse[ base + way ] = 0;
+        // a pending fill in this set should take the freed way
+        if( (missLine & setMask) == (line & setMask) ) missWay = way;
+        return dirty[ base + way ] != 0;
+    }
+
+    // Marks a resident line dirty, returns false if it is not present
+    bool MarkDirty( Addr_t line )
+    {
+        size_t base = Base(line);
+        INT32 way = Find(line, base);
+        if( way < 0 ) return false;
+
+        dirty[ base + way ] = 1;
+        return true;
+    }
+};
+
+class PRIVATE_FILTER
+{
+  private:
+    typedef struct
+    {
+        PRIVATE_CACHE *l1;
+        PRIVATE_CACHE *l2;
+    } CORE_CACHES;
+
+    PRIVATE_FILTER_CONFIG cfg;
+    std::vector<CORE_CACHES> cores;
+
+    PRIVATE_FILTER( const PRIVATE_FILTER & );
+    PRIVATE_FILTER & operator=( const PRIVATE_FILTER & );
+
+    CORE_CACHES & Core( UINT32 tid )
+    {
+        while( cores.size() <= tid )
+        {
+            CORE_CACHES c;
+            c.l1 = new PRIVATE_CACHE(cfg.l1Sets, cfg.l1Assoc, cfg.replPolicy);
+            c.l2 = new PRIVATE_CACHE(cfg.l2Sets, cfg.l2Assoc, cfg.replPolicy);
+            cores.push_back(c);
+        }
+        return cores[tid];
+    }
+
+    static void Emit( LLC_ACCESS *out, UINT32 &n, UINT32 tid, Addr_t PC, Addr_t line, UINT32 type )
+    {
+        out[n].tid        = tid;
+        out[n].PC         = PC;
+        out[n].paddr      = line << 6;
+        out[n].accessType = type;
+        n++;
+    }
+
+  public:
+    // Largest number of records Process can emit for one input
+    static const UINT32 MaxOutputs = 3;
+
+    UINT64 statInputs;
+    UINT64 statL1Hits;
+    UINT64 statL2Hits;
+    UINT64 statLLCRequests;
+    UINT64 statWritebacks;
+
+    PRIVATE_FILTER( const PRIVATE_FILTER_CONFIG &_cfg )
+        : cfg(_cfg), statInputs(0), statL1Hits(0), statL2Hits(0), statLLCRequests(0), statWritebacks(0) {}
+
+    ~PRIVATE_FILTER()
+    {
+        for( size_t ii = 0; ii < cores.size(); ii++ )
+        {
+            delete cores[ii].l1;
+            delete cores[ii].l2;
+        }
+    }
+
+    // Filters one raw access, writes up to MaxOutputs LLC records to out
+    UINT32 Process( const LLC_ACCESS &in, LLC_ACCESS *out )
+    {
+        CORE_CACHES &c = Core(in.tid);
+        Addr_t line = in.paddr >> 6;
+        bool write = (in.accessType == ACCESS_STORE);
+        UINT32 n = 0;
+
+        statInputs++;
+        if( c.l1->Lookup(line, write) )
+        {
+            statL1Hits++;
+            return 0;
+        }
+
+        if( c.l2->Lookup(line, false) )
+        {
+            statL2Hits++;
+        }
+        else
+        {
+            statLLCRequests++;
+            Emit(out, n, in.tid, in.PC, line, in.accessType);
+
+            Addr_t victim;
+            bool victimDirty;
+            if( c.l2->Fill(line, false, victim, victimDirty) )
+            {
+                // an inclusive L2 takes the L1 copy, and its data, with it
+                if( cfg.inclusive && c.l1->Invalidate(victim) ) victimDirty = true;
+                if( victimDirty )
+                {
+                    statWritebacks++;
+                    Emit(out, n, in.tid, 0, victim, ACCESS_WRITEBACK);
+                }
+            }
+        }
+
+        Addr_t victim;
+        bool victimDirty;
+        if( c.l1->Fill(line, write, victim, victimDirty) && victimDirty )
+        {
+            // write the L1 victim back into L2, or past it if L2 dropped it
+            if( !c.l2->MarkDirty(victim) )
+            {
+                statWritebacks++;
+                Emit(out, n, in.tid, 0, victim, ACCESS_WRITEBACK);
+            }
+        }
+        return n;
+    }
+};
+
+#endif
@@ -0,0 +1,134 @@
+/*
+** Streaming front end for PRIVATE_FILTER: reads raw per-core LLC_ACCESS
+** trace records (the 24-byte layout in llc_workload.h, as written by
+** llc_workload_gen --out), runs them through the per-tid L1/L2 and writes
+** the resulting LLC stream in the same layout, which batch_runner and the
+** simulator can replay directly. Filter a raw trace once and reuse the much
+** smaller output for every LLC experiment.
+**
+** "-" reads stdin / writes stdout, so the filter can sit in a pipe, e.g.
+**   llc_workload_gen --out /dev/stdout | private_filter --in - --out llc.bin
+** Without --out only the filter statistics are printed (to stderr).
+**
+** Build: g++ -O2 -std=c++11 -I.. -I<kit include dir> private_filter.cpp
+**
+** Usage: private_filter --in FILE [--out FILE] [--l1 KB:ASSOC] [--l2 KB:ASSOC]
+**                       [--repl lru|plru] [--inclusive | --non-inclusive]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "private_cache_filter.h"
+
+static void Usage( const char *prog )
+{
+    fprintf(stderr, "usage: %s --in FILE [--out FILE] [--l1 KB:ASSOC] [--l2 KB:ASSOC]\n"
+                    "          [--repl lru|plru] [--inclusive | --non-inclusive]\n", prog);
+    exit(1);
+}
+
+// "KB:ASSOC" to sets/assoc for 64B lines, the set count must be a power of 2
+static bool ParseGeometry( const char *spec, UINT32 &sets, UINT32 &assoc )
+{
+    unsigned kb, ways;
+    if( sscanf(spec, "%u:%u", &kb, &ways) != 2 || ways == 0 ) return false;
+    sets  = (kb * 1024 / 64) / ways;
+    assoc = ways;
+    return sets > 0 && (sets & (sets - 1)) == 0;
+}
+
+int main( int argc, char **argv )
+{
+    PRIVATE_FILTER_CONFIG cfg;
+    ParseGeometry("32:8", cfg.l1Sets, cfg.l1Assoc);
+    ParseGeometry("256:8", cfg.l2Sets, cfg.l2Assoc);
+    cfg.replPolicy = PRIV_REPL_LRU;
+    cfg.inclusive  = false;
+
+    const char *inPath = NULL;
+    const char *outPath = NULL;
+
+    for( int ii = 1; ii < argc; ii++ )
+    {
+        bool hasArg = ii + 1 < argc;
+        if( !strcmp(argv[ii], "--in") && hasArg )        inPath = argv[++ii];
+        else if( !strcmp(argv[ii], "--out") && hasArg )  outPath = argv[++ii];
+        else if( !strcmp(argv[ii], "--inclusive") )      cfg.inclusive = true;
+        else if( !strcmp(argv[ii], "--non-inclusive") )  cfg.inclusive = false;
+        else if( !strcmp(argv[ii], "--l1") && hasArg )
+        {
+            if( !ParseGeometry(argv[++ii], cfg.l1Sets, cfg.l1Assoc) ) Usage(argv[0]);
+        }
+        else if( !strcmp(argv[ii], "--l2") && hasArg )
+        {
+            if( !ParseGeometry(argv[++ii], cfg.l2Sets, cfg.l2Assoc) ) Usage(argv[0]);
+        }
+        else if( !strcmp(argv[ii], "--repl") && hasArg )
+        {
+            ii++;
+            if( !strcmp(argv[ii], "lru") )       cfg.replPolicy = PRIV_REPL_LRU;
+            else if( !strcmp(argv[ii], "plru") ) cfg.replPolicy = PRIV_REPL_PLRU;
+            else Usage(argv[0]);
+        }
+        else Usage(argv[0]);
+    }
+    if( !inPath ) Usage(argv[0]);
+
+    if( cfg.replPolicy == PRIV_REPL_PLRU &&
+        ((cfg.l1Assoc & (cfg.l1Assoc - 1)) || (cfg.l2Assoc & (cfg.l2Assoc - 1))) )
+    {
+        fprintf(stderr, "plru needs power-of-two associativity\n");
+        return 1;
+    }
+
+    FILE *in = strcmp(inPath, "-") ? fopen(inPath, "rb") : stdin;
+    if( !in )
+    {
+        perror(inPath);
+        return 1;
+    }
+    FILE *out = NULL;
+    if( outPath )
+    {
+        out = strcmp(outPath, "-") ? fopen(outPath, "wb") : stdout;
+        if( !out )
+        {
+            perror(outPath);
+            return 1;
+        }
+    }
+
+    PRIVATE_FILTER filter(cfg);
+
+    const UINT32 chunk = 64 * 1024;
+    LLC_ACCESS *inBuf  = new LLC_ACCESS[ chunk ];
+    LLC_ACCESS *outBuf = new LLC_ACCESS[ chunk * PRIVATE_FILTER::MaxOutputs ];
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    size_t got;
+    while( (got = fread(inBuf, sizeof(LLC_ACCESS), chunk, in)) > 0 )
+    {
+        UINT32 produced = 0;
+        for( size_t ii = 0; ii < got; ii++ ) produced += filter.Process(inBuf[ii], outBuf + produced);
+        if( out ) fwrite(outBuf, sizeof(LLC_ACCESS), produced, out);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    delete [] inBuf;
+    delete [] outBuf;
+    if( in != stdin ) fclose(in);
+    if( out && out != stdout ) fclose(out);
+
+    UINT64 llc = filter.statLLCRequests + filter.statWritebacks;
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    fprintf(stderr, "inputs:        %llu\n", (unsigned long long) filter.statInputs);
+    fprintf(stderr, "L1 hits:       %llu\n", (unsigned long long) filter.statL1Hits);
+    fprintf(stderr, "L2 hits:       %llu\n", (unsigned long long) filter.statL2Hits);
+    fprintf(stderr, "LLC requests:  %llu\n", (unsigned long long) filter.statLLCRequests);
+    fprintf(stderr, "LLC writebacks:%llu\n", (unsigned long long) filter.statWritebacks);
+    fprintf(stderr, "reduction:     %.1fx\n", llc ? (double) filter.statInputs / llc : 0.0);
+    fprintf(stderr, "rate:          %.1f M inputs/s\n", secs > 0 ? filter.statInputs / secs / 1e6 : 0.0);
+    return 0;
+}
@@ -0,0 +1,388 @@
+/*
+** Microbenchmark for the replacement policy entry points.
+**
+** Replays synthetic access streams through GetVictimInSet and
+** UpdateReplacementState for every CRC_REPL_* policy over a grid of set
+** counts and associativities, and reports ns/access. On Linux, cache misses
+** and instructions are read with perf_event_open when the kernel permits it
+** (perf_event_paranoid), otherwise those columns print n/a.
+**
+** Streams:
+**   hit   random reuse over half the cache capacity, almost all hits
+**   miss  never-reused addresses, every access evicts (for EAF this is the
+**         hash insert/test path and one filter reset per 16K evictions)
+**   mix   1 in 4 accesses reuse a working set twice the cache size
+**   synth the default LLC_WORKLOAD_GEN mixture sized to the cache
+**
+** Each run replays a warm-up stream first, then times a second stream of the
+** same kind on the warmed state. The "model" line times the tag lookup of
+** the harness alone, subtract it to get the cost of the policy calls.
+**
+** --ship SIG:TABLES[:REGIONBITS] selects the SHiP signature and skewed
+** SHCT (see ship_config.h), non-default settings show up in the SHiP row names.
+**
+** Build next to the simulator sources, e.g.
+**   g++ -O2 -std=c++11 -I.. -I<kit include dir> repl_bench.cpp ../replacement_state.cpp
+**
+** --seed S seeds the replacement state (SetRandomSeed, default 1).
+** --sample N turns on the interval sampler every N accesses (ring of 4096)
+** and keeps the benchmark names, so --compare against a run without it
+** shows the sampler overhead.
+**
+** Usage: repl_bench [--accesses N] [--policy P] [--ship SPEC] [--seed S]
+**                   [--sample N] [--json out.json] [--compare base.json]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "replacement_state.h"
+#include "llc_workload.h"
+#include "ship_config.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef struct
+{
+    UINT32  setIndex;
+    Addr_t  tag;
+    Addr_t  PC;
+} BENCH_ACCESS;
+
+typedef struct
+{
+    std::string name;
+    double      nsPerAccess;
+    double      hitRate;
+    INT64       cacheMisses;    // -1 when perf counters are unavailable
+    INT64       instructions;
+} BENCH_RESULT;
+
+static const char *policyNames[] = { "LRU", "RANDOM", "SRRIP", "DRRIP", "SHiP", "EAF" };
+static const UINT32 NumPolicies = 6;
+
+////////////////////////////////////////////////////////////////////////////////
+// perf_event_open wrapper, a counter that failed to open reads as -1
+////////////////////////////////////////////////////////////////////////////////
+class PERF_COUNTER
+{
+  private:
+    int fd;
+
+  public:
+    PERF_COUNTER( UINT32 config ) : fd(-1)
+    {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.size           = sizeof(attr);
+        attr.config         = config;
+        attr.disabled       = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    ~PERF_COUNTER()
+    {
+#ifdef __linux__
+        if( fd >= 0 ) close(fd);
+#endif
+    }
+
+    void Start()
+    {
+#ifdef __linux__
+        if( fd < 0 ) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    INT64 Stop()
+    {
+#ifdef __linux__
+        if( fd < 0 ) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long value = 0;
+        if( read(fd, &value, sizeof(value)) != sizeof(value) ) return -1;
+        return value;
+#else
+        return -1;
+#endif
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Stream generation, xorshift so every run sees the same addresses
+////////////////////////////////////////////////////////////////////////////////
+static UINT64 NextRand( UINT64 &state )
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static void MakeStream( std::vector<BENCH_ACCESS> &stream, const std::string &kind,
+                        UINT32 sets, UINT32 assoc, UINT64 accesses, UINT64 &rng, Addr_t &nextFresh,
+                        LLC_WORKLOAD_GEN *gen )
+{
+    UINT64 lines = (UINT64) sets * assoc;
+    stream.resize(accesses);
+
+    for( UINT64 ii = 0; ii < accesses; ii++ )
+    {
+        if( gen )
+        {
+            LLC_ACCESS a;
+            gen->Next(a);
+            stream[ii].setIndex = (UINT32) ((a.paddr >> 6) % sets);
+            stream[ii].tag      = (a.paddr >> 6) / sets;
+            stream[ii].PC       = a.PC;
+            continue;
+        }
+
+        UINT64 r = NextRand(rng);
+        Addr_t line;
+        if( kind == "hit" )       line = r % (lines / 2);
+        else if( kind == "miss" ) line = nextFresh++;
+        else                      line = ((r & 3) == 0) ? (r >> 2) % (2 * lines) : nextFresh++;
+
+        stream[ii].setIndex = (UINT32) (line % sets);
+        stream[ii].tag      = line / sets;
+        stream[ii].PC       = 0x400000 + ((r >> 40) & 0xff) * 4;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Replay. With repl == NULL only the tag lookup runs and way 0 is replaced.
+////////////////////////////////////////////////////////////////////////////////
+static UINT64 Replay( CACHE_REPLACEMENT_STATE *repl, std::vector<LINE_STATE> &tags,
+                      const std::vector<BENCH_ACCESS> &stream, UINT32 sets, UINT32 assoc )
+{
+    UINT64 hits = 0;
+
+    for( size_t ii = 0; ii < stream.size(); ii++ )
+    {
+        const BENCH_ACCESS &a = stream[ii];
+        LINE_STATE *set = &tags[ (size_t) a.setIndex * assoc ];
+
+        INT32 way = -1;
+        for( UINT32 ww = 0; ww < assoc; ww++ )
+        {
+            if( set[ww].valid && set[ww].tag == a.tag ) { way = ww; break; }
+        }
+
+        if( repl ) repl->IncrementTimer();
+
+        if( way >= 0 )
+        {
+            hits++;
+            if( repl ) repl->UpdateReplacementState( a.setIndex, way, &set[way], 0, a.PC, ACCESS_LOAD, true );
+            continue;
+        }
+
+        // the line address is tag * sets + setIndex, see MakeStream
+        Addr_t paddr = (((Addr_t) a.tag * sets) + a.setIndex) << 6;
+        way = repl ? repl->GetVictimInSet( 0, a.setIndex, set, assoc, a.PC, paddr, ACCESS_LOAD ) : 0;
+        if( way < 0 ) continue;
+
+        set[way].valid = true;
+        set[way].dirty = false;
+        set[way].tag   = a.tag;
+        if( repl ) repl->UpdateReplacementState( a.setIndex, way, &set[way], 0, a.PC, ACCESS_LOAD, false );
+    }
+    return hits;
+}
+
+static BENCH_RESULT RunOne( INT32 policy, UINT32 sets, UINT32 assoc, const std::string &kind, UINT64 accesses,
+                            const SHIP_CONFIG &ship, UINT64 seed, UINT64 sampleInterval )
+{
+    UINT64 rng = 0x9E3779B97F4A7C15ULL ^ ((UINT64) sets << 20) ^ assoc;
+    Addr_t nextFresh = 1ULL << 32;
+
+    LLC_WORKLOAD_GEN *gen = NULL;
+    if( kind == "synth" )
+    {
+        LLC_WORKLOAD_CONFIG cfg;
+        LLC_WORKLOAD_GEN::DefaultConfig(cfg);
+        cfg.workingSetLines = (UINT64) sets * assoc;
+        gen = new LLC_WORKLOAD_GEN(cfg);
+    }
+
+    std::vector<BENCH_ACCESS> warm, timed;
+    MakeStream(warm, kind, sets, assoc, accesses, rng, nextFresh, gen);
+    MakeStream(timed, kind, sets, assoc, accesses, rng, nextFresh, gen);
+    delete gen;
+
+    std::vector<LINE_STATE> tags( (size_t) sets * assoc );
+    for( size_t ii = 0; ii < tags.size(); ii++ )
+    {
+        tags[ii].valid = false;
+        tags[ii].dirty = false;
+        tags[ii].tag   = 0;
+    }
+
+    CACHE_REPLACEMENT_STATE *repl = (policy >= 0) ? new CACHE_REPLACEMENT_STATE(sets, assoc, policy) : NULL;
+    if( repl )
+    {
+        repl->SetSHiPConfig(ship.sigType, ship.numTables, ship.regionBits);
+        repl->SetRandomSeed(seed);
+        if( sampleInterval ) repl->SetSampleInterval(sampleInterval, 4096);
+    }
+
+    Replay(repl, tags, warm, sets, assoc);
+
+    PERF_COUNTER cacheMisses(PERF_COUNT_HW_CACHE_MISSES);
+    PERF_COUNTER instructions(PERF_COUNT_HW_INSTRUCTIONS);
+
+    cacheMisses.Start();
+    instructions.Start();
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    UINT64 hits = Replay(repl, tags, timed, sets, assoc);
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+    BENCH_RESULT res;
+    res.instructions = instructions.Stop();
+    res.cacheMisses  = cacheMisses.Stop();
+    res.nsPerAccess  = std::chrono::duration<double, std::nano>(t1 - t0).count() / accesses;
+    res.hitRate      = (double) hits / accesses;
+
+    char policyName[64];
+    if( policy == CRC_REPL_SHiP && !IsDefaultSHiPConfig(ship) )
+    {
+        snprintf(policyName, sizeof(policyName), "SHiP-%s-x%u-r%u",
+                 SHiPSigNames[ship.sigType], ship.numTables, ship.regionBits);
+    }
+    else
+    {
+        snprintf(policyName, sizeof(policyName), "%s", policy >= 0 ? policyNames[policy] : "model");
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "%s/sets=%u/assoc=%u/%s", policyName, sets, assoc, kind.c_str());
+    res.name = name;
+
+    delete repl;
+    return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Baseline files, one result object per line so they can be read back
+// without a JSON parser
+////////////////////////////////////////////////////////////////////////////////
+static void WriteJSON( const char *path, const std::vector<BENCH_RESULT> &results )
+{
+    std::ofstream out(path);
+    out<<"["<<endl;
+    for( size_t ii = 0; ii < results.size(); ii++ )
+    {
+        const BENCH_RESULT &r = results[ii];
+        out<<"{\"name\": \""<<r.name<<"\", \"ns_per_access\": "<<r.nsPerAccess
+           <<", \"hit_rate\": "<<r.hitRate
+           <<", \"cache_misses\": "<<r.cacheMisses
+           <<", \"instructions\": "<<r.instructions<<"}"
+           <<(ii + 1 < results.size() ? "," : "")<<endl;
+    }
+    out<<"]"<<endl;
+}
+
+static std::map<std::string, double> ReadBaseline( const char *path )
+{
+    std::map<std::string, double> base;
+    std::ifstream in(path);
+    std::string line;
+    while( std::getline(in, line) )
+    {
+        char name[128];
+        double ns;
+        if( sscanf(line.c_str(), "{\"name\": \"%127[^\"]\", \"ns_per_access\": %lf", name, &ns) == 2 )
+        {
+            base[name] = ns;
+        }
+    }
+    return base;
+}
+
+static void PrintCounter( INT64 value )
+{
+    if( value < 0 ) printf(" %14s", "n/a");
+    else printf(" %14lld", (long long) value);
+}
+
+int main( int argc, char **argv )
+{
+    UINT64 accesses = 1 << 20;
+    INT32 onlyPolicy = -1;
+    const char *jsonPath = NULL;
+    const char *basePath = NULL;
+    SHIP_CONFIG ship;
+    DefaultSHiPConfig(ship);
+    UINT64 seed = 1;
+    UINT64 sampleInterval = 0;
+
+    for( int ii = 1; ii < argc; ii++ )
+    {
+        if( !strcmp(argv[ii], "--accesses") && ii + 1 < argc )     accesses = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--policy") && ii + 1 < argc )  onlyPolicy = atoi(argv[++ii]);
+        else if( !strcmp(argv[ii], "--json") && ii + 1 < argc )    jsonPath = argv[++ii];
+        else if( !strcmp(argv[ii], "--compare") && ii + 1 < argc ) basePath = argv[++ii];
+        else if( !strcmp(argv[ii], "--seed") && ii + 1 < argc )    seed = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--sample") && ii + 1 < argc )  sampleInterval = strtoull(argv[++ii], NULL, 0);
+        else if( !strcmp(argv[ii], "--ship") && ii + 1 < argc && ParseSHiPConfig(argv[ii + 1], ship) ) ii++;
+        else
+        {
+            fprintf(stderr, "usage: %s [--accesses N] [--policy P] [--ship SIG:TABLES[:REGIONBITS]]\n"
+                            "          [--seed S] [--sample N] [--json out.json] [--compare base.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const UINT32 setGrid[]   = { 256, 1024, 4096 };
+    static const UINT32 assocGrid[] = { 4, 8, 16, 32 };
+    static const char  *kinds[]     = { "hit", "miss", "mix", "synth" };
+
+    std::map<std::string, double> base;
+    if( basePath ) base = ReadBaseline(basePath);
+
+    printf("%-36s %10s %8s %14s %14s%s\n", "benchmark", "ns/access", "hitrate",
+           "cache-misses", "instructions", basePath ? "   vs base" : "");
+
+    std::vector<BENCH_RESULT> results;
+    for( INT32 policy = -1; policy < (INT32) NumPolicies; policy++ )
+    {
+        if( onlyPolicy >= 0 && policy >= 0 && policy != onlyPolicy ) continue;
+
+        for( UINT32 ss = 0; ss < sizeof(setGrid) / sizeof(setGrid[0]); ss++ )
+        for( UINT32 aa = 0; aa < sizeof(assocGrid) / sizeof(assocGrid[0]); aa++ )
+        for( UINT32 kk = 0; kk < sizeof(kinds) / sizeof(kinds[0]); kk++ )
+        {
+            BENCH_RESULT r = RunOne(policy, setGrid[ss], assocGrid[aa], kinds[kk], accesses, ship, seed, sampleInterval);
+            results.push_back(r);
+
+            printf("%-36s %10.2f %8.3f", r.name.c_str(), r.nsPerAccess, r.hitRate);
+            PrintCounter(r.cacheMisses);
+            PrintCounter(r.instructions);
+            if( base.count(r.name) )
+            {
+                printf("   %+7.1f%%", 100.0 * (r.nsPerAccess - base[r.name]) / base[r.name]);
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    if( jsonPath ) WriteJSON(jsonPath, results);
+    return 0;
+}
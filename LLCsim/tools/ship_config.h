@@ -0,0 +1,55 @@
+#ifndef SHIP_CONFIG_H
+#define SHIP_CONFIG_H
+
+/*
+** Command-line form of CACHE_REPLACEMENT_STATE::SetSHiPConfig shared by the
+** tools:
+**   SIG:TABLES[:REGIONBITS]
+** SIG is pc, mem, path or pcmem (SHiPSignatureType), TABLES is 1 for the
+** plain SHCT or up to SHIP_MAX_TABLES for skewed lookup, REGIONBITS is log2
+** of the region size used by the mem signatures (default 14, 16KB).
+*/
+
+#include <cstdio>
+#include <cstring>
+#include "replacement_state.h"
+
+typedef struct
+{
+    UINT32  sigType;
+    UINT32  numTables;
+    UINT32  regionBits;
+} SHIP_CONFIG;
+
+static inline void DefaultSHiPConfig( SHIP_CONFIG &cfg )
+{
+    cfg.sigType    = SHIP_SIG_PC;
+    cfg.numTables  = 1;
+    cfg.regionBits = SHIP_DEFAULT_REGION_BITS;
+}
+
+static inline bool IsDefaultSHiPConfig( const SHIP_CONFIG &cfg )
+{
+    return cfg.sigType == SHIP_SIG_PC && cfg.numTables == 1 && cfg.regionBits == SHIP_DEFAULT_REGION_BITS;
+}
+
+// Parses spec into cfg, returns false on a syntax or range error
+static inline bool ParseSHiPConfig( const char *spec, SHIP_CONFIG &cfg )
+{
+    char sig[16];
+    unsigned tables, bits = SHIP_DEFAULT_REGION_BITS;
+    int fields = sscanf(spec, "%15[a-z]:%u:%u", sig, &tables, &bits);
+    if( fields < 2 ) return false;
+
+    UINT32 sigType = 0;
+    while( sigType <= SHIP_SIG_PC_MEM && strcmp(sig, SHiPSigNames[sigType]) ) sigType++;
+    if( sigType > SHIP_SIG_PC_MEM ) return false;
+    if( tables == 0 || tables > SHIP_MAX_TABLES || bits < 6 || bits > 63 ) return false;
+
+    cfg.sigType    = sigType;
+    cfg.numTables  = tables;
+    cfg.regionBits = bits;
+    return true;
+}
+
+#endif